@@ -33,6 +33,10 @@
 #define CISCO_MODTYPE_IP_ADDR 37
 #define CISCO_MODTYPE_SUBMASK 38
 #define CISCO_MODTYPE_GATEWAY 39
+#define CISCO_MODTYPE_ALLOW_VLAN_RANGE 40
+#define CISCO_MODTYPE_ALLOW_VLAN_SET 41
+#define CISCO_MODTYPE_NAME 42
+#define CISCO_MODTYPE_DESC_INTERNED 43
 
 #define CISCO_ERROR_INVALID_ACTION 48
 #define CISCO_ERROR_INVALID_VALUE 49
@@ -40,4 +44,48 @@
 #define CISCO_ERROR_OUT_OF_RANGE 51
 #define CISCO_ERROR_PL32LIB_GC 52
 #define CISCO_ERROR_MISMATCHED_IPVER 53
+#define CISCO_ERROR_IO 54
+#define CISCO_ERROR_TIMEOUT 55
+#define CISCO_ERROR_CONFLICT 56
+
+#define CISCO_SINK_BUFFER 64
+#define CISCO_SINK_FD 65
+#define CISCO_SINK_CALLBACK 66
+
+#define CISCO_MEDIA_FASTETH 80
+#define CISCO_MEDIA_GIGABIT 81
+#define CISCO_MEDIA_TENGIG 82
+#define CISCO_MEDIA_ETHERNET 83
+#define CISCO_MEDIA_SERIAL 84
+#define CISCO_MEDIA_PORTCH 85
+#define CISCO_MEDIA_VLAN 86
+
+#define CISCO_FLOW_NONE 96
+#define CISCO_FLOW_RTSCTS 97
+#define CISCO_FLOW_XONXOFF 98
+
+#define CISCO_SUBNET_DUPLICATE 112
+#define CISCO_SUBNET_OVERLAP 113
+#define CISCO_SUBNET_GATEWAY 114
+
+#define CISCO_PHASE_READ 128
+#define CISCO_PHASE_TOKENIZE 129
+#define CISCO_PHASE_PARSE 130
+#define CISCO_PHASE_RENDER_TABLE 131
+#define CISCO_PHASE_RENDER_INT 132
+#define CISCO_PHASE_CONCAT 133
+#define CISCO_PHASE_WRITE 134
+
+#define CISCO_DESC_MAXSIZE 255
+#define CISCO_INTNAME_MAXSIZE 32
+#define CISCO_ADDR_MAXSTRING 50
+#define CISCO_CMDLINE_MAXSIZE 512
+#define CISCO_VLANSET_MAXSTRING 10240
+#define CISCO_VLAN_MAX 4094
+#define CISCO_VLANSET_WORDS 64
+#define CISCO_PUSH_WINDOW 4
+#define CISCO_PUSH_TIMEOUT 10000
+#define CISCO_PHASE_COUNT 7
+#define CISCO_SNAPSHOT_MAGIC "CISCOMDL"
+#define CISCO_SNAPSHOT_VERSION 1
 
@@ -14,29 +14,256 @@ typedef struct ciscomisc {
 	char* line_passwd;
 	char* enable_passwd;
 	char* enable_secret;
-	char* hostname
+	char* hostname;
 } ciscomisc_t;
+typedef struct ciscovlanset {
+	uint64_t bits[64];
+} ciscovlanset_t;
+typedef struct ciscointname {
+	uint8_t media;
+	uint8_t depth;
+	uint8_t slot;
+	uint8_t subslot;
+	uint16_t port;
+	uint16_t lastPort;
+} ciscointname_t;
+typedef struct ciscovector {
+	plarray_t items;
+	size_t capacity;
+	size_t elementSize;
+	plgc_t* gc;
+} ciscovector_t;
+typedef struct ciscoregion ciscoregion_t;
+typedef struct ciscoregionstats {
+	size_t currentBytes;
+	size_t peakBytes;
+	size_t reservedBytes;
+	size_t allocations;
+	size_t chunks;
+	size_t resets;
+} ciscoregionstats_t;
 typedef struct ciscoint ciscoint_t;
 typedef struct ciscotable ciscotable_t;
+typedef struct ciscomodel ciscomodel_t;
+typedef struct ciscostrpool ciscostrpool_t;
+typedef struct ciscoportindex ciscoportindex_t;
 typedef uint8_t ciscoconst_t;
+typedef struct ciscoportconflict {
+	ciscointname_t name;
+	ciscoconst_t type;
+	uint16_t number;
+} ciscoportconflict_t;
+typedef struct ciscoip {
+	uint8_t bytes[16];
+	uint8_t prefix;
+	bool isIPv6;
+} ciscoip_t;
+typedef struct ciscopool ciscopool_t;
+typedef struct ciscoprofile ciscoprofile_t;
+typedef struct ciscoportsettings {
+	ciscoconst_t mode;
+	uint16_t vlan;
+	const char* description;
+	const ciscovlanset_t* allowedVlans;
+} ciscoportsettings_t;
+typedef struct ciscosubnetcheck ciscosubnetcheck_t;
+typedef struct ciscosubnetissue {
+	ciscoconst_t type;
+	uint32_t device;
+	ciscointname_t name;
+	char address[CISCO_ADDR_MAXSTRING];
+	bool hasOther;
+	uint32_t otherDevice;
+	ciscointname_t otherName;
+	char otherAddress[CISCO_ADDR_MAXSTRING];
+} ciscosubnetissue_t;
+typedef struct ciscosink ciscosink_t;
+typedef int (*ciscosinkfunc_t)(void* userData, const char* data, size_t size);
+typedef struct ciscopush ciscopush_t;
+typedef struct ciscosource ciscosource_t;
+typedef struct ciscopushstats {
+	size_t linesSent;
+	size_t linesAcked;
+	size_t totalLines;
+	size_t errors;
+	size_t firstErrorLine;
+	double elapsed;
+	double linesPerSecond;
+} ciscopushstats_t;
+typedef struct ciscostats ciscostats_t;
+typedef struct ciscophasestats {
+	double wallTime;
+	double cpuTime;
+	size_t calls;
+	size_t items;
+	size_t allocations;
+	size_t allocBytes;
+	size_t bytes;
+} ciscophasestats_t;
+
+size_t ciscoGetAllocCount(void);
+size_t ciscoGetAllocBytes(void);
+
+ciscostats_t* ciscoCreateStats(void);
+ciscostats_t* ciscoUseStats(ciscostats_t* stats);
+void ciscoStatsBegin(ciscoconst_t phase);
+void ciscoStatsEnd(ciscoconst_t phase, size_t items, size_t bytes);
+ciscoconst_t ciscoStatsGetPhase(ciscostats_t* stats, ciscoconst_t phase, ciscophasestats_t* phaseStats);
+const char* ciscoStatsPhaseName(ciscoconst_t phase);
+void ciscoStatsReset(ciscostats_t* stats);
+void ciscoDestroyStats(ciscostats_t* stats);
+
+ciscoregion_t* ciscoCreateRegion(size_t chunkSize);
+ciscoregion_t* ciscoUseRegion(ciscoregion_t* region);
+ciscoregion_t* ciscoGetRegion(void);
+void ciscoRegionReset(ciscoregion_t* region);
+void ciscoRegionGetStats(ciscoregion_t* region, ciscoregionstats_t* stats);
+void ciscoDestroyRegion(ciscoregion_t* region);
+
+ciscoconst_t ciscoVectorInit(ciscovector_t* vector, size_t elementSize, size_t capacity, plgc_t* gc);
+ciscoconst_t ciscoVectorReserve(ciscovector_t* vector, size_t capacity);
+ciscoconst_t ciscoVectorAppend(ciscovector_t* vector, const void* elements, size_t count);
+ciscoconst_t ciscoVectorPush(ciscovector_t* vector, const void* element);
+void* ciscoVectorAt(ciscovector_t* vector, size_t index);
+void ciscoVectorFree(ciscovector_t* vector);
+
+ciscoconst_t ciscoCidrToOctet(uint8_t cidrMask, uint8_t* octets);
+ciscoconst_t ciscoParseIP(const char* string, ciscoip_t* ip);
+void ciscoIPMask(const ciscoip_t* ip, ciscoip_t* mask);
+void ciscoIPNetwork(const ciscoip_t* ip, ciscoip_t* network);
+void ciscoIPBroadcast(const ciscoip_t* ip, ciscoip_t* broadcast);
+bool ciscoIPContains(const ciscoip_t* subnet, const ciscoip_t* ip);
+size_t ciscoFormatIP(const ciscoip_t* ip, char* buffer);
+
+ciscopool_t* ciscoCreatePool(const char* name, const ciscoip_t* prefix, plgc_t* gc);
+ciscoconst_t ciscoPoolAllocate(ciscopool_t* pool, uint8_t prefix, ciscoip_t* block);
+ciscoconst_t ciscoPoolAllocateHost(ciscopool_t* pool, ciscoip_t* host);
+ciscoconst_t ciscoPoolAllocateSubnet(ciscopool_t* pool, uint8_t prefix, ciscoip_t* address);
+ciscoconst_t ciscoPoolReserve(ciscopool_t* pool, const ciscoip_t* block);
+ciscoconst_t ciscoPoolRelease(ciscopool_t* pool, const ciscoip_t* block);
+const char* ciscoPoolGetName(ciscopool_t* pool);
+const ciscoip_t* ciscoPoolGetPrefix(ciscopool_t* pool);
+size_t ciscoPoolGetBlocks(ciscopool_t* pool);
+void ciscoDestroyPool(ciscopool_t* pool);
 
-plarray_t* ciscoCidrToOctet(uint8_t cidrMask, plgc_t* gc);
 char* ciscoGenerateIntString(ciscoconst_t type, plgc_t* gc);
 ciscoconst_t ciscoStringToIntType(char* string);
+ciscoconst_t ciscoParseIntNames(const char* string, ciscointname_t* names, size_t maxNames, size_t* amount);
+size_t ciscoFormatIntName(const ciscointname_t* name, char* buffer);
 char* ciscoGenerateModeString(ciscoconst_t mode, plgc_t* gc);
+const char* ciscoModeToString(ciscoconst_t mode);
 ciscoconst_t ciscoStringToMode(char* string);
 
 ciscoint_t* ciscoCreateInterface(ciscoconst_t type, uint8_t port1, uint8_t port2, plgc_t* gc);
+ciscoint_t* ciscoCreateInterfaceFromName(const ciscointname_t* name, plgc_t* gc);
 ciscotable_t* ciscoCreateTable(ciscoconst_t type, ciscoconst_t mode, uint16_t number, plgc_t* gc);
 
 ciscoconst_t ciscoModifyInterface(ciscoint_t* interface, plgc_t* gc, ciscoconst_t modType, ...);
 ciscoconst_t ciscoModifyTable(ciscotable_t* table, plgc_t* gc, ciscoconst_t modType, ...);
 
 int ciscoAddInterface(ciscotable_t* table, ciscoint_t* interface, plgc_t* gc);
+int ciscoAddInterfaces(ciscotable_t* table, ciscoint_t** interfaces, size_t count, plgc_t* gc);
 ciscoint_t* ciscoGetInterface(ciscotable_t* table, int index);
+const ciscointname_t* ciscoGetInterfaceName(ciscoint_t* interface);
+
+void ciscoVlanSetClear(ciscovlanset_t* set);
+void ciscoVlanSetAdd(ciscovlanset_t* set, uint16_t vlan);
+void ciscoVlanSetAddRange(ciscovlanset_t* set, uint16_t first, uint16_t last);
+void ciscoVlanSetRemove(ciscovlanset_t* set, uint16_t vlan);
+bool ciscoVlanSetTest(ciscovlanset_t* set, uint16_t vlan);
+void ciscoVlanSetUnion(ciscovlanset_t* dest, ciscovlanset_t* src);
+void ciscoVlanSetIntersect(ciscovlanset_t* dest, ciscovlanset_t* src);
+void ciscoVlanSetExcept(ciscovlanset_t* dest, ciscovlanset_t* src);
+size_t ciscoVlanSetCount(ciscovlanset_t* set);
+ciscoconst_t ciscoVlanSetParse(ciscovlanset_t* set, const char* string);
+ciscoconst_t ciscoVlanSetFormat(ciscovlanset_t* set, ciscosink_t* sink);
+
+ciscostrpool_t* ciscoCreateStringPool(plgc_t* gc);
+const char* ciscoStringPoolIntern(ciscostrpool_t* pool, const char* string);
+size_t ciscoStringPoolSize(ciscostrpool_t* pool);
+
+ciscoportindex_t* ciscoCreatePortIndex(plgc_t* gc);
+ciscoconst_t ciscoPortIndexClaim(ciscoportindex_t* index, const ciscotable_t* table, ciscoint_t** interfaces, size_t count, ciscoportconflict_t* conflict);
+ciscoconst_t ciscoPortIndexAddTable(ciscoportindex_t* index, const ciscotable_t* table, ciscoportconflict_t* conflict);
+void ciscoDestroyPortIndex(ciscoportindex_t* index);
+
+ciscomodel_t* ciscoCreateModel(plgc_t* gc);
+int ciscoModelAddInterface(ciscomodel_t* model, ciscoint_t* interface);
+int ciscoModelAddInterfaces(ciscomodel_t* model, ciscoint_t** interfaces, size_t count);
+int ciscoModelAddTableInterfaces(ciscomodel_t* model, ciscotable_t* table, ciscoint_t** interfaces, size_t count);
+const ciscoportconflict_t* ciscoModelGetConflict(ciscomodel_t* model);
+int ciscoModelAddPool(ciscomodel_t* model, ciscopool_t* pool);
+ciscopool_t* ciscoModelFindPool(ciscomodel_t* model, const char* name);
+int ciscoModelAddProfile(ciscomodel_t* model, const char* name, const ciscoportsettings_t* settings);
+ciscoprofile_t* ciscoModelFindProfile(ciscomodel_t* model, const char* name);
+int ciscoModelApplyProfile(ciscomodel_t* model, ciscoprofile_t* profile, const ciscointname_t* names, size_t count);
+int ciscoModelOverridePorts(ciscomodel_t* model, const ciscointname_t* names, size_t count, const ciscoportsettings_t* settings);
+int ciscoModelAddTable(ciscomodel_t* model, ciscotable_t* table);
+int ciscoModelAddTables(ciscomodel_t* model, ciscotable_t** tables, size_t count);
+ciscotable_t* ciscoModelFindTable(ciscomodel_t* model, ciscoconst_t type, uint16_t number);
+ciscotable_t* ciscoModelGetTable(ciscomodel_t* model, ciscoconst_t type, uint16_t number, ciscoconst_t mode);
+int ciscoModelMergeTable(ciscomodel_t* model, ciscotable_t* table);
+int ciscoModelReserve(ciscomodel_t* model, size_t interfaceCount, size_t tableCount);
+plarray_t* ciscoModelGetInterfaces(ciscomodel_t* model);
+plarray_t* ciscoModelGetTables(ciscomodel_t* model);
+ciscomisc_t* ciscoModelGetMisc(ciscomodel_t* model);
+ciscostrpool_t* ciscoModelGetStringPool(ciscomodel_t* model);
+plgc_t* ciscoModelGetGC(ciscomodel_t* model);
+ciscosubnetcheck_t* ciscoCreateSubnetCheck(void);
+ciscoconst_t ciscoSubnetCheckAddModel(ciscosubnetcheck_t* check, ciscomodel_t* model, uint32_t device);
+size_t ciscoSubnetCheckRun(ciscosubnetcheck_t* check, const ciscosubnetissue_t** issues);
+void ciscoSubnetCheckReset(ciscosubnetcheck_t* check);
+void ciscoDestroySubnetCheck(ciscosubnetcheck_t* check);
+
+ciscoconst_t ciscoSaveModel(ciscomodel_t* model, ciscosink_t* sink);
+ciscomodel_t* ciscoLoadModel(const char* path, plgc_t* gc);
+
+ciscosink_t* ciscoCreateSink(ciscoconst_t type, plgc_t* gc, ...);
+ciscoconst_t ciscoSinkWrite(ciscosink_t* sink, const char* data, size_t size);
+ciscoconst_t ciscoSinkPuts(ciscosink_t* sink, const char* string);
+ciscoconst_t ciscoSinkFlush(ciscosink_t* sink);
+ciscoconst_t ciscoSinkReserve(ciscosink_t* sink, size_t size);
+char* ciscoSinkGetBuffer(ciscosink_t* sink, size_t* size);
+size_t ciscoSinkTell(ciscosink_t* sink);
+void ciscoSinkSetCompact(ciscosink_t* sink, bool compact);
+bool ciscoSinkIsCompact(ciscosink_t* sink);
+void ciscoSinkReset(ciscosink_t* sink);
+void ciscoDestroySink(ciscosink_t* sink);
+
+ciscoconst_t ciscoRenderInterface(ciscoint_t* interface, ciscosink_t* sink);
+ciscoconst_t ciscoRenderTable(ciscotable_t* table, ciscosink_t* sink);
+ciscoconst_t ciscoRenderProfilePorts(ciscomodel_t* model, ciscosink_t* sink);
+ciscoconst_t ciscoRenderModel(ciscomodel_t* model, ciscosink_t* sink);
+ciscoconst_t ciscoRenderModelCached(ciscomodel_t* model, ciscosink_t* sink, size_t* rerendered);
+ciscoconst_t ciscoRenderModelCoalesced(ciscomodel_t* model, ciscosink_t* sink);
+ciscoconst_t ciscoRenderModelCoalescedCached(ciscomodel_t* model, ciscosink_t* sink, size_t* rerendered);
+ciscoconst_t ciscoRenderModelDelta(ciscomodel_t* from, ciscomodel_t* to, ciscosink_t* sink, size_t* changed);
+
+bool ciscoIsBaudRate(uint32_t baudRate);
+ciscoconst_t ciscoConfigureTerminal(int fd, uint32_t baudRate, ciscoconst_t flowControl);
+ciscopush_t* ciscoCreatePush(int fd, const char* script, size_t size, uint16_t window, int timeout, plgc_t* gc);
+int ciscoPushGetFD(ciscopush_t* push);
+bool ciscoPushWantsWrite(ciscopush_t* push);
+bool ciscoPushDone(ciscopush_t* push);
+ciscoconst_t ciscoPushRead(ciscopush_t* push);
+ciscoconst_t ciscoPushWrite(ciscopush_t* push);
+ciscoconst_t ciscoPushCheckTimeout(ciscopush_t* push);
+ciscoconst_t ciscoPushRun(ciscopush_t* push);
+ciscoconst_t ciscoPushRunAll(ciscopush_t** pushes, size_t count, ciscoconst_t* results);
+void ciscoPushGetStats(ciscopush_t* push, ciscopushstats_t* stats);
+void ciscoDestroyPush(ciscopush_t* push);
+
+ciscosource_t* ciscoOpenSource(const char* path, plgc_t* gc);
+ciscosource_t* ciscoSourceSlice(ciscosource_t* source, size_t start, size_t end, plgc_t* gc);
+plarray_t* ciscoSourceNextLine(ciscosource_t* source);
+size_t ciscoSourceGetLine(ciscosource_t* source);
+size_t ciscoSourceGetSize(ciscosource_t* source);
+const char* ciscoSourceGetData(ciscosource_t* source);
+void ciscoCloseSource(ciscosource_t* source);
 
 plfile_t* ciscoParseInterface(ciscoint_t* interface, plgc_t* gc);
 plfile_t* ciscoParseTable(ciscotable_t* table, plgc_t* gc);
 
 void ciscoPrintInterface(ciscoint_t* interface, plgc_t* gc);
 void ciscoPrintTable(ciscotable_t* table, plgc_t* gc);
+void ciscoPrintModel(ciscomodel_t* model);
@@ -5,504 +5,6015 @@
 \************************************/
 #include <ciscolib-const.h>
 #include <ciscolib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <termios.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
-// Cisco Interface Structure
+#define CISCO_SINK_FD_BUFSIZE 4096
+#define CISCO_STRPOOL_CHUNKSIZE 4096
+#define CISCO_ADDR_HAS_IP 1
+#define CISCO_ADDR_HAS_GATEWAY 2
+#define CISCO_ADDR_IPV6 4
+#define CISCO_PUSH_LINEBUF 256
+#define CISCO_RANGE_MAXNAMES 5
+#define CISCO_REGION_CHUNKSIZE (1024 * 1024)
+#define CISCO_REGION_MAXCHUNK (64 * 1024 * 1024)
+#define CISCO_REGION_ALIGN 16
+#define CISCO_PORTINDEX_MINPORTS 64
+#define CISCO_POOL_FULL 0xff
+#define CISCO_STATS_MAXDEPTH 8
+#define CISCO_STATS_CPU_INTERVAL 1.0
+#define CISCO_DIRTY_SNIPPET 1
+#define CISCO_DIRTY_GROUP 2
+#define CISCO_DIRTY_ALL 3
+
+// Cisco Interface Address Structure. Only allocated for interfaces that have an
+// address or gateway configured
+typedef struct ciscoaddr {
+	uint8_t ipAddr[16];
+	uint8_t gateway[16];
+	uint8_t subMask;
+	uint8_t flags;
+} ciscoaddr_t;
+
+// Cached output of the last render of an interface or table
+typedef struct ciscosnippet {
+	char* data;
+	uint32_t size;
+	uint32_t capacity;
+} ciscosnippet_t;
+
+// Cisco Port Profile Structure. Unset settings are zero or NULL
+struct ciscoprofile {
+	const char* name;
+	ciscoportsettings_t settings;
+};
+
+// Settings of one port of a profile range that differ from its profile
+typedef struct ciscoportoverride {
+	uint16_t port;
+	ciscoportsettings_t settings;
+} ciscoportoverride_t;
+
+// Ports of one module a profile was applied to. The ports are only expanded
+// while rendering, so a range takes the same memory for any amount of ports.
+// Overrides are sorted by port
+typedef struct ciscoprofilerange {
+	ciscointname_t name;
+	ciscoprofile_t* profile;
+	ciscovector_t overrides;
+} ciscoprofilerange_t;
+
+// One port of an interface, as listed by the delta renderer
+typedef struct ciscoportentry {
+	uint64_t key;
+	size_t order;
+	ciscoint_t* interface;
+	ciscotable_t* table;
+	ciscoprofilerange_t* range;
+	bool pinned;
+} ciscoportentry_t;
+
+// Effective configuration of a single port once every command that touches
+// it has been applied
+typedef struct ciscoportstate {
+	ciscointname_t name;
+	ciscoconst_t mode;
+	uint16_t vlan;
+	bool trunkVlan;
+	uint16_t channel;
+	ciscoconst_t channelMode;
+	const char* description;
+	const ciscoaddr_t* ipAddr;
+	const ciscoaddr_t* gateway;
+	const ciscovlanset_t* allowedVlans;
+	char descBuffer[CISCO_DESC_MAXSIZE + 1];
+} ciscoportstate_t;
+
+// Model snapshot header. A snapshot is the header followed by the VLAN sets,
+// the address blocks, the interface records (standalone interfaces first,
+// then the members of every table), the table records and the string data.
+// String, address and VLAN set references are stored as index + 1, with 0
+// meaning none, and every section is in the host's byte order
+typedef struct ciscosnapheader {
+	char magic[8];
+	uint32_t byteOrder;
+	uint32_t version;
+	uint32_t interfaceCount;
+	uint32_t standaloneCount;
+	uint32_t tableCount;
+	uint32_t addressCount;
+	uint32_t vlanSetCount;
+	uint32_t stringSize;
+	uint32_t misc[4];
+	uint64_t vlanSetOffset;
+	uint64_t addressOffset;
+	uint64_t interfaceOffset;
+	uint64_t tableOffset;
+	uint64_t stringOffset;
+	uint64_t fileSize;
+} ciscosnapheader_t;
+
+// Model snapshot interface record
+typedef struct ciscosnapint {
+	ciscointname_t name;
+	uint8_t mode;
+	uint8_t reserved[3];
+	uint32_t description;
+	uint32_t address;
+	uint32_t allowedVlans;
+} ciscosnapint_t;
+
+// Model snapshot table record
+typedef struct ciscosnaptable {
+	uint8_t type;
+	uint8_t mode;
+	uint16_t number;
+	uint32_t name;
+	uint32_t firstMember;
+	uint32_t memberCount;
+} ciscosnaptable_t;
+
+// Cisco Interface Structure. Every renderer that caches output clears its own
+// CISCO_DIRTY_* bit once it has rendered the interface
 struct ciscoint {
-	ciscoconst_t type;
+	ciscointname_t name;
 	ciscoconst_t mode;
-	uint8_t ports[2];
-	char description[256];
-	plarray_t* allowedVlans;
-	char ipAddr[46];
-	uint8_t subMask;
-	char gateway[46];
-	size_t preExitBufmark;
+	uint8_t dirty;
+	const char* description;
+	ciscovlanset_t* allowedVlans;
+	ciscoaddr_t* address;
+	ciscosnippet_t snippet;
 };
 
-// Cisco Table Structure
+// Cisco Table Structure. group caches the coalesced output of the table and
+// its members, in the form and for the member count it was rendered with
 struct ciscotable {
 	ciscoconst_t type;
 	ciscoconst_t mode;
+	uint8_t dirty;
 	char name[128];
 	uint16_t number;
-	plarray_t* interfaces;
+	ciscovector_t interfaces;
+	ciscosnippet_t snippet;
+	ciscosnippet_t group;
+	size_t groupMembers;
+	bool groupCompact;
+};
+
+// Cisco Interned String Pool Structure
+struct ciscostrpool {
+	char** slots;
+	size_t capacity;
+	size_t size;
+	char* chunk;
+	size_t chunkUsed;
+	plgc_t* gc;
+};
+
+// Ports of one module in a port ownership index. Modules are keyed by the
+// packed name of their ports without the port number
+typedef struct ciscoportmodule {
+	uint32_t key;
+	size_t portCount;
+	uint64_t* configured;
+	uint16_t* vlan;
+	uint16_t* channel;
+} ciscoportmodule_t;
+
+// Cisco Port Ownership Index Structure
+struct ciscoportindex {
+	ciscoportmodule_t** slots;
+	size_t slotCount;
+	size_t moduleCount;
+	plgc_t* gc;
+};
+
+// Node of the allocation tree of an address pool. A node covers the block of
+// its prefix length and is either a leaf, which is free or used as a whole,
+// or split into the two halves of its block. maxFree is the shortest prefix
+// length of a free block below it, or CISCO_POOL_FULL if there is none.
+// Children are indexes into the nodes of the pool, and 0 means none
+typedef struct ciscopoolnode {
+	uint32_t child[2];
+	uint8_t maxFree;
+} ciscopoolnode_t;
+
+// Cisco Address Pool Structure. freePair chains the node pairs left over
+// by merges through the first child of their first node
+struct ciscopool {
+	char* name;
+	ciscoip_t prefix;
+	ciscovector_t nodes;
+	uint32_t freePair;
+	size_t blocks;
+	plgc_t* gc;
+};
+
+// Addressed interface of a subnet check, copied out of its model
+typedef struct ciscosubnetentry {
+	ciscointname_t name;
+	ciscoaddr_t address;
+	uint32_t device;
+	uint32_t order;
+	uint32_t next;
+} ciscosubnetentry_t;
+
+// Node of the binary trie of a subnet check. Children and entries are
+// indexes, the entries of a prefix are chained through their next field
+// starting from 1, and 0 means none
+typedef struct ciscotrienode {
+	uint32_t child[2];
+	uint32_t first;
+	uint32_t last;
+} ciscotrienode_t;
+
+// Cisco Subnet Check Structure. Everything it holds lives in its own region
+struct ciscosubnetcheck {
+	ciscoregion_t* region;
+	ciscovector_t entries;
+	ciscovector_t nodes;
+	ciscovector_t issues;
+};
+
+// Cisco Device Model Structure
+struct ciscomodel {
+	ciscovector_t interfaces;
+	ciscovector_t tables;
+	ciscotable_t** tableSlots;
+	size_t tableSlotCount;
+	size_t indexedTables;
+	ciscoportindex_t* ports;
+	ciscoportconflict_t conflict;
+	ciscovector_t pools;
+	ciscovector_t profiles;
+	ciscovector_t profileRanges;
+	ciscovector_t sortedRanges;
+	ciscomisc_t misc;
+	ciscostrpool_t* strings;
+	ciscosink_t* scratch;
+	ciscosnippet_t standalone;
+	size_t standaloneCount;
+	bool standaloneCompact;
+	bool standaloneCached;
+	void* mapping;
+	size_t mappingSize;
+	plgc_t* gc;
+};
+
+// Cisco Output Sink Structure
+struct ciscosink {
+	ciscoconst_t type;
+	int fd;
+	ciscosinkfunc_t function;
+	void* userData;
+	char* buffer;
+	size_t size;
+	size_t capacity;
+	size_t written;
+	bool compact;
+	plgc_t* gc;
+};
+
+// Cisco Serial Push Engine Structure
+struct ciscopush {
+	int fd;
+	const char* script;
+	size_t size;
+	size_t writeOffset;
+	size_t totalLines;
+	size_t linesSent;
+	size_t linesAcked;
+	size_t errors;
+	size_t firstErrorLine;
+	uint16_t window;
+	int timeout;
+	bool pokeSent;
+	bool synced;
+	bool skipLine;
+	uint32_t pollEvents;
+	char lineBuf[CISCO_PUSH_LINEBUF];
+	size_t lineSize;
+	struct timespec start;
+	struct timespec lastProgress;
+	struct timespec end;
+	plgc_t* gc;
+};
+
+// Region chunk header. The allocations of a chunk follow it, each one after a
+// header holding its size
+typedef struct ciscoregionchunk {
+	struct ciscoregionchunk* next;
+	size_t size;
+	size_t used;
+	size_t pad;
+} ciscoregionchunk_t;
+
+// Cisco Region Allocator Structure. Allocations are bumped out of a list of
+// chunks that is kept across resets, so a reset only rewinds to the first
+// chunk and a region that has been through one device needs no new memory
+// for the next one of a similar size
+struct ciscoregion {
+	ciscoregionchunk_t* first;
+	ciscoregionchunk_t* current;
+	size_t nextChunkSize;
+	size_t usedBefore;
+	size_t reserved;
+	size_t peak;
+	size_t allocations;
+	size_t chunks;
+	size_t resets;
+	void* last;
+};
+
+// Stats mark, the point the phase on top of a stats stack was last accounted at
+typedef struct ciscostatsmark {
+	ciscoconst_t phase;
+	struct timespec wall;
+	size_t allocations;
+	size_t allocBytes;
+} ciscostatsmark_t;
+
+// Cisco Stats Collector Structure. Phases nest, and time and allocations are
+// only added to the innermost one, so the phases of a run add up to its total.
+// Reading the CPU clock costs more than tokenizing a line, so it is only
+// sampled every CISCO_STATS_CPU_INTERVAL ms and the CPU time in between is
+// split between the phases that ran by their wall time
+struct ciscostats {
+	ciscophasestats_t phases[CISCO_PHASE_COUNT];
+	ciscostatsmark_t stack[CISCO_STATS_MAXDEPTH];
+	size_t depth;
+	size_t overflow;
+	double pendingWall[CISCO_PHASE_COUNT];
+	struct timespec sampleWall;
+	struct timespec sampleCpu;
+	bool sampled;
+};
+
+// Cisco Source Reader Structure. The whole source is mapped (or read, when it
+// can't be mapped) with one spare byte at the end, and lines are tokenized by
+// terminating every token in place
+struct ciscosource {
+	char* data;
+	size_t size;
+	size_t offset;
+	size_t lineNum;
+	bool mapped;
+	bool borrowed;
+	plarray_t tokens;
+	size_t tokenCapacity;
+	plgc_t* gc;
+};
+
+// Amount of heap allocations made by ciscolib on the current thread
+static __thread size_t ciscoAllocCount = 0;
+
+// Amount of bytes requested from ciscolib's allocator on the current thread
+static __thread size_t ciscoAllocBytes = 0;
+
+// Region ciscolib allocates from on the current thread, if any
+static __thread ciscoregion_t* ciscoActiveRegion = NULL;
+
+// Stats collector phases are recorded into on the current thread, if any
+static __thread ciscostats_t* ciscoActiveStats = NULL;
+
+// Phase name table, indexed by CISCO_PHASE_* - CISCO_PHASE_READ
+static const char* const ciscoPhaseTable[CISCO_PHASE_COUNT] = {
+	"read", "tokenize", "parse", "render_tables", "render_interfaces", "concat", "write"
+};
+
+// Mode keyword table, indexed by CISCO_MODE_* - CISCO_MODE_ACCESS
+static const char* const ciscoModeTable[] = {
+	"access", "trunk", "active", "passive", "desirable", "auto", "on", NULL
+};
+
+// Render keyword table. The compact forms are the shortest abbreviations IOS
+// accepts unambiguously in the mode each keyword is used in. An empty
+// compact form means the command is left out
+#define CISCO_KW_INT 0
+#define CISCO_KW_INT_RANGE 1
+#define CISCO_KW_SW_MODE 2
+#define CISCO_KW_IP_ADDR 3
+#define CISCO_KW_IPV6_ADDR 4
+#define CISCO_KW_DESC 5
+#define CISCO_KW_ALLOWED 6
+#define CISCO_KW_ACCESS_VLAN 7
+#define CISCO_KW_TRUNK_VLAN 8
+#define CISCO_KW_CHANNEL 9
+#define CISCO_KW_MODE 10
+#define CISCO_KW_GATEWAY 11
+#define CISCO_KW_EXIT 12
+#define CISCO_KW_VLAN 13
+#define CISCO_KW_NAME 14
+#define CISCO_KW(isCompact, index) ((isCompact) ? ciscoKeywordTable[index].compact : ciscoKeywordTable[index].full)
+
+static const struct {
+	const char* full;
+	const char* compact;
+} ciscoKeywordTable[] = {
+	[CISCO_KW_INT] = { "int ", "int " },
+	[CISCO_KW_INT_RANGE] = { "int range ", "int ra " },
+	[CISCO_KW_SW_MODE] = { "switchport mode ", "sw mo " },
+	[CISCO_KW_IP_ADDR] = { "ip address ", "ip add " },
+	[CISCO_KW_IPV6_ADDR] = { "ipv6 address ", "ipv6 add " },
+	[CISCO_KW_DESC] = { "description ", "desc " },
+	[CISCO_KW_ALLOWED] = { "switchport trunk allowed vlan ", "sw tr al vl " },
+	[CISCO_KW_ACCESS_VLAN] = { "switchport access vlan ", "sw acc vl " },
+	[CISCO_KW_TRUNK_VLAN] = { "switchport trunk vlan ", "sw tr vl " },
+	[CISCO_KW_CHANNEL] = { "channel-group ", "channel-g " },
+	[CISCO_KW_MODE] = { " mode ", " mo " },
+	[CISCO_KW_GATEWAY] = { "ip default-gateway ", "ip default-g " },
+	// The next global command leaves interface and VLAN mode on its own
+	[CISCO_KW_EXIT] = { "exit\n", "" },
+	[CISCO_KW_VLAN] = { "vlan ", "vlan " },
+	[CISCO_KW_NAME] = { "name ", "na " }
+};
+
+// Compact mode keywords, indexed like ciscoModeTable
+static const char* const ciscoCompactModeTable[] = {
+	"acc", "tr", "act", "pas", "de", "au", "on", NULL
+};
+
+// Interface media keyword table, indexed by CISCO_MEDIA_* - CISCO_MEDIA_FASTETH.
+// Names can be abbreviated down to minSize characters
+static const struct {
+	const char* name;
+	const char* shortName;
+	uint8_t minSize;
+	uint8_t minDepth;
+	uint8_t maxDepth;
+} ciscoMediaTable[] = {
+	{ "fastethernet", "f", 1, 2, 3 },
+	{ "gigabitethernet", "g", 1, 2, 3 },
+	{ "tengigabitethernet", "te", 2, 2, 3 },
+	{ "ethernet", "e", 1, 2, 3 },
+	{ "serial", "s", 1, 2, 3 },
+	{ "port-channel", "po", 2, 1, 1 },
+	{ "vlan", "vlan", 2, 1, 1 }
+};
+
+// Interface names matching each of the legacy CISCO_INT_* constants
+static const ciscointname_t ciscoLegacyTypes[] = {
+	[CISCO_INT_F0] = { CISCO_MEDIA_FASTETH, 2, 0, 0, 0, 0 },
+	[CISCO_INT_G0] = { CISCO_MEDIA_GIGABIT, 2, 0, 0, 0, 0 },
+	[CISCO_INT_G00] = { CISCO_MEDIA_GIGABIT, 3, 0, 0, 0, 0 },
+	[CISCO_INT_G01] = { CISCO_MEDIA_GIGABIT, 3, 0, 1, 0, 0 },
+	[CISCO_INT_S00] = { CISCO_MEDIA_SERIAL, 3, 0, 0, 0, 0 },
+	[CISCO_INT_S01] = { CISCO_MEDIA_SERIAL, 3, 0, 1, 0, 0 },
+	[CISCO_INT_F1] = { CISCO_MEDIA_FASTETH, 2, 1, 0, 0, 0 },
+	[CISCO_INT_G1] = { CISCO_MEDIA_GIGABIT, 2, 1, 0, 0, 0 },
+	[CISCO_INT_G10] = { CISCO_MEDIA_GIGABIT, 3, 1, 0, 0, 0 },
+	[CISCO_INT_G11] = { CISCO_MEDIA_GIGABIT, 3, 1, 1, 0, 0 },
+	[CISCO_INT_VLAN] = { CISCO_MEDIA_VLAN, 1, 0, 0, 0, 0 },
+	[CISCO_INT_PORTCH] = { CISCO_MEDIA_PORTCH, 1, 0, 0, 0, 0 }
 };
 
-// Converts a IPv4 CIDR subnet mask into an octet-based mask address
-plarray_t* ciscoCidrToOctet(uint8_t cidrMask, plgc_t* gc){
-	if(cidrMask > 32)
-		return NULL;
+// Creates a region allocator. chunkSize is the size of the first chunk, 0
+// picks the default. Later chunks double in size up to a limit, or are as
+// big as the allocation that needed them
+ciscoregion_t* ciscoCreateRegion(size_t chunkSize){
+	ciscoregion_t* returnRegion = calloc(1, sizeof(ciscoregion_t));
+
+	if(returnRegion)
+		returnRegion->nextChunkSize = chunkSize ? chunkSize : CISCO_REGION_CHUNKSIZE;
+
+	return returnRegion;
+}
+
+// Makes ciscolib allocate from a region on the calling thread, or from the
+// pl32lib memory tracker again if region is NULL. Objects have to be grown
+// and freed in the same mode they were allocated in. Returns the region that
+// was in use before
+ciscoregion_t* ciscoUseRegion(ciscoregion_t* region){
+	ciscoregion_t* previous = ciscoActiveRegion;
+
+	ciscoActiveRegion = region;
+	return previous;
+}
+
+// Gets the region ciscolib allocates from on the calling thread
+ciscoregion_t* ciscoGetRegion(void){
+	return ciscoActiveRegion;
+}
+
+// Moves a region on to a chunk with room for need bytes, reusing the chunks
+// kept from before the last reset when they are big enough
+static bool ciscoRegionNextChunk(ciscoregion_t* region, size_t need){
+	ciscoregionchunk_t* chunk = region->current ? region->current->next : region->first;
+
+	if(!chunk || chunk->size < need){
+		size_t size = region->nextChunkSize > need ? region->nextChunkSize : need;
+
+		chunk = malloc(sizeof(ciscoregionchunk_t) + size);
+		if(!chunk)
+			return false;
+
+		chunk->size = size;
+		region->reserved += size;
+		region->chunks++;
+
+		if(region->nextChunkSize < CISCO_REGION_MAXCHUNK)
+			region->nextChunkSize *= 2;
+
+		// New chunks go right after the current one, so chunks that were
+		// too small for this allocation are still reused after a reset
+		if(region->current){
+			chunk->next = region->current->next;
+			region->current->next = chunk;
+		}else{
+			chunk->next = region->first;
+			region->first = chunk;
+		}
+	}
+
+	if(region->current)
+		region->usedBefore += region->current->used;
+
+	chunk->used = 0;
+	region->current = chunk;
+
+	return true;
+}
+
+static void* ciscoRegionAlloc(ciscoregion_t* region, size_t size){
+	size_t payload = (size + CISCO_REGION_ALIGN - 1) & ~(size_t)(CISCO_REGION_ALIGN - 1);
+	size_t need = payload + CISCO_REGION_ALIGN;
+
+	if(!region->current || region->current->used + need > region->current->size){
+		if(!ciscoRegionNextChunk(region, need))
+			return NULL;
+	}
+
+	char* header = (char*)(region->current + 1) + region->current->used;
+	*(size_t*)header = payload;
+	region->current->used += need;
+	region->allocations++;
+	region->last = header + CISCO_REGION_ALIGN;
+
+	if(region->usedBefore + region->current->used > region->peak)
+		region->peak = region->usedBefore + region->current->used;
+
+	return region->last;
+}
+
+// Grows an allocation of a region. The last allocation grows in place if its
+// chunk has room, anything else is copied to a new allocation
+static void* ciscoRegionRealloc(ciscoregion_t* region, void* pointer, size_t size){
+	if(!pointer)
+		return ciscoRegionAlloc(region, size);
+
+	size_t* oldSize = (size_t*)((char*)pointer - CISCO_REGION_ALIGN);
+	if(size <= *oldSize)
+		return pointer;
+
+	size_t payload = (size + CISCO_REGION_ALIGN - 1) & ~(size_t)(CISCO_REGION_ALIGN - 1);
+	if(pointer == region->last && region->current->used + payload - *oldSize <= region->current->size){
+		region->current->used += payload - *oldSize;
+		*oldSize = payload;
+
+		if(region->usedBefore + region->current->used > region->peak)
+			region->peak = region->usedBefore + region->current->used;
+
+		return pointer;
+	}
+
+	void* newPointer = ciscoRegionAlloc(region, size);
+	if(newPointer)
+		memcpy(newPointer, pointer, *oldSize);
+
+	return newPointer;
+}
+
+// Frees an allocation of a region. Only the last allocation is given back,
+// everything else stays until the region is reset
+static void ciscoRegionFree(ciscoregion_t* region, void* pointer){
+	if(pointer && pointer == region->last){
+		region->current->used -= *(size_t*)((char*)pointer - CISCO_REGION_ALIGN) + CISCO_REGION_ALIGN;
+		region->last = NULL;
+	}
+}
+
+// Frees everything allocated from a region at once. The chunks are kept for
+// the allocations that come after
+void ciscoRegionReset(ciscoregion_t* region){
+	region->current = region->first;
+	if(region->current)
+		region->current->used = 0;
+
+	region->usedBefore = 0;
+	region->peak = 0;
+	region->allocations = 0;
+	region->last = NULL;
+	region->resets++;
+}
+
+// Gets the memory statistics of a region. The peak and the allocation count
+// cover the time since the last reset
+void ciscoRegionGetStats(ciscoregion_t* region, ciscoregionstats_t* stats){
+	stats->currentBytes = region->usedBefore + (region->current ? region->current->used : 0);
+	stats->peakBytes = region->peak;
+	stats->reservedBytes = region->reserved;
+	stats->allocations = region->allocations;
+	stats->chunks = region->chunks;
+	stats->resets = region->resets;
+}
+
+void ciscoDestroyRegion(ciscoregion_t* region){
+	ciscoregionchunk_t* chunk = region->first;
+
+	while(chunk){
+		ciscoregionchunk_t* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	if(ciscoActiveRegion == region)
+		ciscoActiveRegion = NULL;
+
+	free(region);
+}
+
+// Counted wrappers around the pl32lib memory tracker, or the region in use on
+// the calling thread
+static void* ciscoGCAlloc(plgc_t* gc, size_t size){
+	ciscoAllocCount++;
+	ciscoAllocBytes += size;
+
+	if(ciscoActiveRegion)
+		return ciscoRegionAlloc(ciscoActiveRegion, size);
+
+	return plGCAlloc(gc, size);
+}
+
+static void* ciscoGCCalloc(plgc_t* gc, size_t amount, size_t size){
+	ciscoAllocCount++;
+	ciscoAllocBytes += amount * size;
+
+	if(ciscoActiveRegion){
+		void* pointer = ciscoRegionAlloc(ciscoActiveRegion, amount * size);
+
+		if(pointer)
+			memset(pointer, 0, amount * size);
+
+		return pointer;
+	}
+
+	return plGCCalloc(gc, amount, size);
+}
+
+static void* ciscoGCRealloc(plgc_t* gc, void* pointer, size_t size){
+	ciscoAllocCount++;
+	ciscoAllocBytes += size;
+
+	if(ciscoActiveRegion)
+		return ciscoRegionRealloc(ciscoActiveRegion, pointer, size);
+
+	return plGCRealloc(gc, pointer, size);
+}
+
+static void ciscoGCFree(plgc_t* gc, void* pointer){
+	if(ciscoActiveRegion){
+		ciscoRegionFree(ciscoActiveRegion, pointer);
+	}else{
+		plGCFree(gc, pointer);
+	}
+}
+
+// Gets the amount of heap allocations ciscolib has made on the calling thread
+size_t ciscoGetAllocCount(void){
+	return ciscoAllocCount;
+}
+
+// Gets the amount of bytes ciscolib has requested from its allocator on the
+// calling thread. Reallocations count with their new size
+size_t ciscoGetAllocBytes(void){
+	return ciscoAllocBytes;
+}
+
+// Gets the time in milliseconds between two timestamps
+static double ciscoElapsedMs(const struct timespec* start, const struct timespec* end){
+	return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+// Creates an empty stats collector
+ciscostats_t* ciscoCreateStats(void){
+	return calloc(1, sizeof(ciscostats_t));
+}
+
+// Makes ciscolib record its phases into a stats collector on the calling
+// thread, or stops recording if stats is NULL. Returns the collector that was
+// in use before
+ciscostats_t* ciscoUseStats(ciscostats_t* stats){
+	ciscostats_t* previous = ciscoActiveStats;
+
+	ciscoActiveStats = stats;
+	return previous;
+}
+
+// Takes the current time and allocation counters
+static void ciscoStatsMark(ciscostatsmark_t* mark){
+	clock_gettime(CLOCK_MONOTONIC, &mark->wall);
+	mark->allocations = ciscoAllocCount;
+	mark->allocBytes = ciscoAllocBytes;
+}
+
+// Adds everything since the top of the stack was marked up to now to its
+// phase, and marks it again at now
+static void ciscoStatsAccount(ciscostats_t* stats, const ciscostatsmark_t* now){
+	if(!stats->depth)
+		return;
+
+	ciscostatsmark_t* top = &stats->stack[stats->depth - 1];
+	ciscophasestats_t* phase = &stats->phases[top->phase - CISCO_PHASE_READ];
+	double wallTime = ciscoElapsedMs(&top->wall, &now->wall) / 1000;
+
+	phase->wallTime += wallTime;
+	phase->allocations += now->allocations - top->allocations;
+	phase->allocBytes += now->allocBytes - top->allocBytes;
+	stats->pendingWall[top->phase - CISCO_PHASE_READ] += wallTime;
+
+	top->wall = now->wall;
+	top->allocations = now->allocations;
+	top->allocBytes = now->allocBytes;
+}
+
+// Samples the CPU clock if the last sample is old enough or force is set, and
+// splits the CPU time since the last sample between the phases that ran. CPU
+// time is taken for the whole process, so it includes the threads working
+// for the calling one
+static void ciscoStatsSampleCpu(ciscostats_t* stats, const struct timespec* wall, bool force){
+	struct timespec cpu;
+	double pendingTotal = 0;
+
+	if(stats->sampled && !force && ciscoElapsedMs(&stats->sampleWall, wall) < CISCO_STATS_CPU_INTERVAL)
+		return;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+
+	for(int i = 0; i < CISCO_PHASE_COUNT; i++)
+		pendingTotal += stats->pendingWall[i];
+
+	if(stats->sampled && pendingTotal > 0){
+		double cpuTime = ciscoElapsedMs(&stats->sampleCpu, &cpu) / 1000;
+
+		for(int i = 0; i < CISCO_PHASE_COUNT; i++)
+			stats->phases[i].cpuTime += cpuTime * stats->pendingWall[i] / pendingTotal;
+	}
+
+	memset(stats->pendingWall, 0, sizeof(stats->pendingWall));
+	stats->sampleWall = *wall;
+	stats->sampleCpu = cpu;
+	stats->sampled = true;
+}
+
+// Starts a phase in the stats collector of the calling thread. The phase
+// that was running is paused until the new one ends. Does nothing if no
+// collector is in use
+void ciscoStatsBegin(ciscoconst_t phase){
+	ciscostats_t* stats = ciscoActiveStats;
+	ciscostatsmark_t now;
+
+	if(!stats || phase < CISCO_PHASE_READ || phase >= CISCO_PHASE_READ + CISCO_PHASE_COUNT)
+		return;
+
+	if(stats->depth == CISCO_STATS_MAXDEPTH){
+		stats->overflow++;
+		return;
+	}
+
+	ciscoStatsMark(&now);
+	ciscoStatsAccount(stats, &now);
+
+	// Nothing outside of a phase is recorded, so the first one starts afresh
+	ciscoStatsSampleCpu(stats, &now.wall, stats->depth == 0);
+
+	now.phase = phase;
+	stats->stack[stats->depth] = now;
+	stats->depth++;
+	stats->phases[phase - CISCO_PHASE_READ].calls++;
+}
+
+// Ends a phase started with ciscoStatsBegin(), adding the amount of items
+// (lines, objects...) and bytes it went through to it. Phases that were
+// started after it and never ended are dropped
+void ciscoStatsEnd(ciscoconst_t phase, size_t items, size_t bytes){
+	ciscostats_t* stats = ciscoActiveStats;
+	ciscostatsmark_t now;
+	size_t depth;
+
+	if(!stats)
+		return;
+
+	if(stats->overflow){
+		stats->overflow--;
+		return;
+	}
+
+	for(depth = stats->depth; depth > 0 && stats->stack[depth - 1].phase != phase; depth--);
+
+	if(!depth)
+		return;
+
+	ciscoStatsMark(&now);
+	stats->depth = depth;
+	ciscoStatsAccount(stats, &now);
+	stats->depth--;
+	ciscoStatsSampleCpu(stats, &now.wall, stats->depth == 0);
+	stats->phases[phase - CISCO_PHASE_READ].items += items;
+	stats->phases[phase - CISCO_PHASE_READ].bytes += bytes;
+
+	// The phase that was paused carries on from here
+	if(stats->depth){
+		ciscostatsmark_t* top = &stats->stack[stats->depth - 1];
+
+		now.phase = top->phase;
+		*top = now;
+	}
+}
+
+// Gets what a stats collector recorded for a phase. Phases that are still
+// running only include what was recorded up to their last pause
+ciscoconst_t ciscoStatsGetPhase(ciscostats_t* stats, ciscoconst_t phase, ciscophasestats_t* phaseStats){
+	if(phase < CISCO_PHASE_READ || phase >= CISCO_PHASE_READ + CISCO_PHASE_COUNT)
+		return CISCO_ERROR_INVALID_VALUE;
+
+	*phaseStats = stats->phases[phase - CISCO_PHASE_READ];
+	return 0;
+}
+
+// Gets the name of a phase, or NULL if it isn't one
+const char* ciscoStatsPhaseName(ciscoconst_t phase){
+	if(phase < CISCO_PHASE_READ || phase >= CISCO_PHASE_READ + CISCO_PHASE_COUNT)
+		return NULL;
+
+	return ciscoPhaseTable[phase - CISCO_PHASE_READ];
+}
+
+// Clears everything a stats collector recorded, including running phases
+void ciscoStatsReset(ciscostats_t* stats){
+	memset(stats, 0, sizeof(ciscostats_t));
+}
+
+void ciscoDestroyStats(ciscostats_t* stats){
+	if(ciscoActiveStats == stats)
+		ciscoActiveStats = NULL;
+
+	free(stats);
+}
+
+// Initializes an empty vector of elements of elementSize bytes with room for
+// capacity of them
+ciscoconst_t ciscoVectorInit(ciscovector_t* vector, size_t elementSize, size_t capacity, plgc_t* gc){
+	vector->items.array = NULL;
+	vector->items.size = 0;
+	vector->capacity = 0;
+	vector->elementSize = elementSize;
+	vector->gc = gc;
+
+	return ciscoVectorReserve(vector, capacity);
+}
+
+// Makes sure a vector has room for at least capacity elements without
+// growing again
+ciscoconst_t ciscoVectorReserve(ciscovector_t* vector, size_t capacity){
+	if(capacity <= vector->capacity)
+		return 0;
+
+	void* tempPtr = ciscoGCRealloc(vector->gc, vector->items.array, capacity * vector->elementSize);
+
+	if(!tempPtr)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	vector->items.array = tempPtr;
+	vector->capacity = capacity;
+
+	return 0;
+}
+
+// Appends count elements to a vector. The capacity at least doubles whenever
+// it runs out, so appending n elements one by one takes O(n) time overall
+ciscoconst_t ciscoVectorAppend(ciscovector_t* vector, const void* elements, size_t count){
+	size_t size = vector->items.size;
+
+	if(size + count > vector->capacity){
+		size_t capacity = vector->capacity < 4 ? 4 : vector->capacity * 2;
+
+		while(capacity < size + count)
+			capacity *= 2;
+
+		if(ciscoVectorReserve(vector, capacity))
+			return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	memcpy((char*)vector->items.array + size * vector->elementSize, elements, count * vector->elementSize);
+	vector->items.size += count;
+
+	return 0;
+}
+
+// Appends one element to a vector
+ciscoconst_t ciscoVectorPush(ciscovector_t* vector, const void* element){
+	return ciscoVectorAppend(vector, element, 1);
+}
+
+// Gets a pointer to an element of a vector, or NULL if index is out of range
+void* ciscoVectorAt(ciscovector_t* vector, size_t index){
+	if(index >= vector->items.size)
+		return NULL;
+
+	return (char*)vector->items.array + index * vector->elementSize;
+}
+
+// Frees the elements of a vector and leaves it empty
+void ciscoVectorFree(ciscovector_t* vector){
+	if(vector->items.array)
+		ciscoGCFree(vector->gc, vector->items.array);
+
+	vector->items.array = NULL;
+	vector->items.size = 0;
+	vector->capacity = 0;
+}
+
+// Formatting kernels used by the render path. Each one appends to dest and
+// returns the new end of the string, which is not null-terminated
+static char* ciscoAppendString(char* dest, const char* string){
+	while(*string){
+		*dest = *string;
+		dest++;
+		string++;
+	}
+
+	return dest;
+}
+
+static char* ciscoAppendUint(char* dest, uint32_t value){
+	char digits[10];
+	int size = 0;
+
+	do{
+		digits[size] = '0' + value % 10;
+		value /= 10;
+		size++;
+	}while(value);
+
+	while(size){
+		size--;
+		*dest = digits[size];
+		dest++;
+	}
+
+	return dest;
+}
+
+static char* ciscoAppendIPv4(char* dest, const uint8_t* bytes){
+	for(int i = 0; i < 4; i++){
+		if(i){
+			*dest = '.';
+			dest++;
+		}
+
+		dest = ciscoAppendUint(dest, bytes[i]);
+	}
+
+	return dest;
+}
+
+// Appends an IPv6 address in RFC 5952 form (lowercase, longest zero run compressed)
+static char* ciscoAppendIPv6(char* dest, const uint8_t* bytes){
+	static const char hexDigits[] = "0123456789abcdef";
+	uint16_t groups[8];
+	int zeroStart = -1;
+	int zeroSize = 0;
+
+	for(int i = 0; i < 8; i++)
+		groups[i] = (bytes[i * 2] << 8) | bytes[i * 2 + 1];
+
+	for(int i = 0; i < 8; i++){
+		int size = 0;
+
+		while(i + size < 8 && groups[i + size] == 0)
+			size++;
+
+		if(size > zeroSize && size > 1){
+			zeroStart = i;
+			zeroSize = size;
+		}
+
+		if(size)
+			i += size - 1;
+	}
+
+	for(int i = 0; i < 8; i++){
+		if(i == zeroStart){
+			dest = ciscoAppendString(dest, "::");
+			i += zeroSize - 1;
+			continue;
+		}
+
+		if(i && i != zeroStart + zeroSize){
+			*dest = ':';
+			dest++;
+		}
+
+		bool started = false;
+		for(int shift = 12; shift >= 0; shift -= 4){
+			uint8_t nibble = (groups[i] >> shift) & 0xf;
+
+			if(nibble || started || shift == 0){
+				*dest = hexDigits[nibble];
+				dest++;
+				started = true;
+			}
+		}
+	}
+
+	return dest;
+}
+
+// Dotted form of every IPv4 prefix length
+static const char* ciscoDottedMaskTable[33] = {
+	"0.0.0.0", "128.0.0.0", "192.0.0.0", "224.0.0.0",
+	"240.0.0.0", "248.0.0.0", "252.0.0.0", "254.0.0.0",
+	"255.0.0.0", "255.128.0.0", "255.192.0.0", "255.224.0.0",
+	"255.240.0.0", "255.248.0.0", "255.252.0.0", "255.254.0.0",
+	"255.255.0.0", "255.255.128.0", "255.255.192.0", "255.255.224.0",
+	"255.255.240.0", "255.255.248.0", "255.255.252.0", "255.255.254.0",
+	"255.255.255.0", "255.255.255.128", "255.255.255.192", "255.255.255.224",
+	"255.255.255.240", "255.255.255.248", "255.255.255.252", "255.255.255.254",
+	"255.255.255.255"
+};
+
+static char* ciscoAppendMask(char* dest, uint8_t cidrMask){
+	return ciscoAppendString(dest, ciscoDottedMaskTable[cidrMask]);
+}
+
+static char* ciscoAppendIntName(char* dest, const ciscointname_t* name){
+	dest = ciscoAppendString(dest, ciscoMediaTable[name->media - CISCO_MEDIA_FASTETH].shortName);
+
+	if(name->depth > 1){
+		dest = ciscoAppendUint(dest, name->slot);
+		*dest = '/';
+		dest++;
+	}
+
+	if(name->depth > 2){
+		dest = ciscoAppendUint(dest, name->subslot);
+		*dest = '/';
+		dest++;
+	}
+
+	dest = ciscoAppendUint(dest, name->port);
+
+	if(name->lastPort != name->port){
+		*dest = '-';
+		dest = ciscoAppendUint(dest + 1, name->lastPort);
+	}
+
+	return dest;
+}
+
+// Converts a IPv4 CIDR subnet mask into the 4 octets of its mask address
+ciscoconst_t ciscoCidrToOctet(uint8_t cidrMask, uint8_t* octets){
+	if(cidrMask > 32)
+		return CISCO_ERROR_OUT_OF_RANGE;
+
+	uint32_t mask = cidrMask ? ~(uint32_t)0 << (32 - cidrMask) : 0;
+
+	octets[0] = mask >> 24;
+	octets[1] = mask >> 16;
+	octets[2] = mask >> 8;
+	octets[3] = mask;
+
+	return 0;
+}
+
+// Parses an IPv4 or IPv6 address with an optional prefix length
+// ("10.0.0.1/24"). Addresses without one get a host prefix
+ciscoconst_t ciscoParseIP(const char* string, ciscoip_t* ip){
+	const char* slash = strchr(string, '/');
+	size_t addrSize = slash ? (size_t)(slash - string) : strlen(string);
+	char addrString[46];
+
+	if(addrSize > 45)
+		return CISCO_ERROR_BUFFER_OVERFLOW;
+
+	memcpy(addrString, string, addrSize);
+	addrString[addrSize] = '\0';
+	memset(ip->bytes, 0, sizeof(ip->bytes));
+	ip->isIPv6 = memchr(string, ':', addrSize) != NULL;
+
+	if(inet_pton(ip->isIPv6 ? AF_INET6 : AF_INET, addrString, ip->bytes) != 1)
+		return CISCO_ERROR_INVALID_VALUE;
+
+	ip->prefix = ip->isIPv6 ? 128 : 32;
+
+	if(slash){
+		char* end;
+		long prefix = strtol(slash + 1, &end, 10);
+
+		if(!isdigit((unsigned char)slash[1]) || *end != '\0')
+			return CISCO_ERROR_INVALID_VALUE;
+
+		if(prefix > ip->prefix)
+			return CISCO_ERROR_OUT_OF_RANGE;
+
+		ip->prefix = prefix;
+	}
+
+	return 0;
+}
+
+// Loads the bytes of an address into two big-endian 64-bit halves
+static void ciscoIPLoad(const uint8_t* bytes, uint64_t* halves){
+	halves[0] = 0;
+	halves[1] = 0;
+
+	for(int i = 0; i < 8; i++){
+		halves[0] = halves[0] << 8 | bytes[i];
+		halves[1] = halves[1] << 8 | bytes[i + 8];
+	}
+}
+
+// Stores two 64-bit halves back into the bytes of an address
+static void ciscoIPStore(uint8_t* bytes, const uint64_t* halves){
+	for(int i = 0; i < 8; i++){
+		bytes[i] = halves[0] >> (56 - i * 8);
+		bytes[i + 8] = halves[1] >> (56 - i * 8);
+	}
+}
+
+// Gets the mask of a prefix length as two 64-bit halves. IPv4 addresses only
+// use the top 32 bits of the first half
+static void ciscoIPPrefixMask(uint8_t prefix, uint64_t* mask){
+	mask[0] = prefix == 0 ? 0 : prefix >= 64 ? ~(uint64_t)0 : ~(uint64_t)0 << (64 - prefix);
+	mask[1] = prefix <= 64 ? 0 : ~(uint64_t)0 << (128 - prefix);
+}
+
+// Gets the subnet mask of an address, as an address with the same prefix
+void ciscoIPMask(const ciscoip_t* ip, ciscoip_t* mask){
+	uint64_t halves[2];
+
+	ciscoIPPrefixMask(ip->prefix, halves);
+	ciscoIPStore(mask->bytes, halves);
+
+	if(!ip->isIPv6)
+		memset(mask->bytes + 4, 0, 12);
+
+	mask->prefix = ip->prefix;
+	mask->isIPv6 = ip->isIPv6;
+}
+
+// Gets the network address of the subnet of an address
+void ciscoIPNetwork(const ciscoip_t* ip, ciscoip_t* network){
+	uint64_t halves[2];
+	uint64_t mask[2];
+
+	ciscoIPLoad(ip->bytes, halves);
+	ciscoIPPrefixMask(ip->prefix, mask);
+	halves[0] &= mask[0];
+	halves[1] &= mask[1];
+	ciscoIPStore(network->bytes, halves);
+
+	network->prefix = ip->prefix;
+	network->isIPv6 = ip->isIPv6;
+}
+
+// Gets the broadcast address of the subnet of an address, which is the last
+// address of the subnet for IPv6
+void ciscoIPBroadcast(const ciscoip_t* ip, ciscoip_t* broadcast){
+	uint64_t halves[2];
+	uint64_t mask[2];
+
+	ciscoIPLoad(ip->bytes, halves);
+	ciscoIPPrefixMask(ip->prefix, mask);
+	halves[0] |= ~mask[0];
+	halves[1] |= ~mask[1];
+
+	// IPv4 addresses end after the first 32 bits
+	if(!ip->isIPv6){
+		halves[0] &= ~(uint64_t)0 << 32;
+		halves[1] = 0;
+	}
+
+	ciscoIPStore(broadcast->bytes, halves);
+	broadcast->prefix = ip->prefix;
+	broadcast->isIPv6 = ip->isIPv6;
+}
+
+// Checks whether an address is in the subnet of another one
+bool ciscoIPContains(const ciscoip_t* subnet, const ciscoip_t* ip){
+	uint64_t a[2];
+	uint64_t b[2];
+	uint64_t mask[2];
+
+	if(subnet->isIPv6 != ip->isIPv6)
+		return false;
+
+	ciscoIPLoad(subnet->bytes, a);
+	ciscoIPLoad(ip->bytes, b);
+	ciscoIPPrefixMask(subnet->prefix, mask);
+
+	return ((a[0] ^ b[0]) & mask[0]) == 0 && ((a[1] ^ b[1]) & mask[1]) == 0;
+}
+
+// Writes an address and its prefix length to a buffer of at least
+// CISCO_ADDR_MAXSTRING bytes. Returns the size of the string
+size_t ciscoFormatIP(const ciscoip_t* ip, char* buffer){
+	char* end = ip->isIPv6 ? ciscoAppendIPv6(buffer, ip->bytes) : ciscoAppendIPv4(buffer, ip->bytes);
+
+	*end = '/';
+	end = ciscoAppendUint(end + 1, ip->prefix);
+	*end = '\0';
+
+	return end - buffer;
+}
+
+// Creates an empty address pool that hands out blocks of a prefix
+// ("10.0.0.0/16"). Host bits set in the prefix are ignored
+ciscopool_t* ciscoCreatePool(const char* name, const ciscoip_t* prefix, plgc_t* gc){
+	ciscopool_t* returnPool = ciscoGCAlloc(gc, sizeof(ciscopool_t));
+	ciscopoolnode_t root = { { 0, 0 }, prefix->prefix };
+
+	returnPool->name = ciscoGCAlloc(gc, strlen(name) + 1);
+	strcpy(returnPool->name, name);
+	ciscoIPNetwork(prefix, &returnPool->prefix);
+	ciscoVectorInit(&returnPool->nodes, sizeof(ciscopoolnode_t), 16, gc);
+	ciscoVectorPush(&returnPool->nodes, &root);
+	returnPool->freePair = 0;
+	returnPool->blocks = 0;
+	returnPool->gc = gc;
+
+	return returnPool;
+}
+
+// Gets a node of the allocation tree of a pool
+static ciscopoolnode_t* ciscoPoolNode(ciscopool_t* pool, uint32_t index){
+	return (ciscopoolnode_t*)pool->nodes.items.array + index;
+}
+
+// Gets the bit of an address loaded with ciscoIPLoad() at a prefix length
+static int ciscoPoolBit(const uint64_t* halves, uint8_t bit){
+	return halves[bit / 64] >> (63 - bit % 64) & 1;
+}
+
+// Splits a free leaf of a pool into its two free halves. The halves are
+// stored next to each other, and pairs freed by merges are reused first.
+// The node array may move, so node pointers have to be fetched again
+static ciscoconst_t ciscoPoolSplit(ciscopool_t* pool, uint32_t index, uint8_t prefix){
+	ciscopoolnode_t half = { { 0, 0 }, prefix + 1 };
+	uint32_t first = pool->freePair;
+
+	if(first){
+		pool->freePair = ciscoPoolNode(pool, first)->child[0];
+		*ciscoPoolNode(pool, first) = half;
+		*ciscoPoolNode(pool, first + 1) = half;
+	}else{
+		first = pool->nodes.items.size;
+
+		if(ciscoVectorPush(&pool->nodes, &half) || ciscoVectorPush(&pool->nodes, &half))
+			return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	ciscoPoolNode(pool, index)->child[0] = first;
+	ciscoPoolNode(pool, index)->child[1] = first + 1;
+
+	return 0;
+}
+
+// Recomputes the free space of the first depth nodes of a path from the root
+// after a block below them changed, merging halves that are both free again
+static void ciscoPoolUpdate(ciscopool_t* pool, const uint32_t* path, size_t depth){
+	while(depth > 0){
+		depth--;
+
+		ciscopoolnode_t* node = ciscoPoolNode(pool, path[depth]);
+		ciscopoolnode_t* low = ciscoPoolNode(pool, node->child[0]);
+		ciscopoolnode_t* high = ciscoPoolNode(pool, node->child[1]);
+		uint8_t prefix = pool->prefix.prefix + depth;
+
+		// Only a free leaf can have its own prefix length as free space
+		if(low->maxFree == prefix + 1 && high->maxFree == prefix + 1){
+			low->child[0] = pool->freePair;
+			pool->freePair = node->child[0];
+			node->child[0] = 0;
+			node->child[1] = 0;
+			node->maxFree = prefix;
+		}else{
+			node->maxFree = low->maxFree < high->maxFree ? low->maxFree : high->maxFree;
+		}
+	}
+}
+
+// Allocates the lowest free block of a prefix length from a pool. Returns
+// CISCO_ERROR_OUT_OF_RANGE if the pool has no free block that large left.
+// Only the nodes on the path to the block are visited, so an allocation
+// takes time proportional to the prefix length
+ciscoconst_t ciscoPoolAllocate(ciscopool_t* pool, uint8_t prefix, ciscoip_t* block){
+	uint8_t width = pool->prefix.isIPv6 ? 128 : 32;
+	uint8_t current = pool->prefix.prefix;
+	uint32_t path[128];
+	uint64_t halves[2];
+	uint32_t index = 0;
+
+	if(prefix < current || prefix > width)
+		return CISCO_ERROR_INVALID_VALUE;
+
+	if(ciscoPoolNode(pool, 0)->maxFree > prefix)
+		return CISCO_ERROR_OUT_OF_RANGE;
+
+	ciscoIPLoad(pool->prefix.bytes, halves);
+
+	// Halves are never larger than their node, so the lower half with a
+	// block that large has one of exactly that size further down
+	while(current < prefix){
+		path[current - pool->prefix.prefix] = index;
+
+		if(!ciscoPoolNode(pool, index)->child[0] && ciscoPoolSplit(pool, index, current)){
+			ciscoPoolUpdate(pool, path, current - pool->prefix.prefix);
+			return CISCO_ERROR_PL32LIB_GC;
+		}
+
+		ciscopoolnode_t* node = ciscoPoolNode(pool, index);
+		int side = ciscoPoolNode(pool, node->child[0])->maxFree <= prefix ? 0 : 1;
+
+		halves[current / 64] |= (uint64_t)side << (63 - current % 64);
+		index = node->child[side];
+		current++;
+	}
+
+	ciscoPoolNode(pool, index)->maxFree = CISCO_POOL_FULL;
+	ciscoPoolUpdate(pool, path, prefix - pool->prefix.prefix);
+	pool->blocks++;
+
+	ciscoIPStore(block->bytes, halves);
+	block->prefix = prefix;
+	block->isIPv6 = pool->prefix.isIPv6;
+
+	return 0;
+}
+
+// Allocates the lowest free host address of a pool, with the prefix length of
+// the pool so it can be assigned to an interface as is. The network address,
+// and the broadcast address of IPv4 pools, are never handed out
+ciscoconst_t ciscoPoolAllocateHost(ciscopool_t* pool, ciscoip_t* host){
+	uint8_t width = pool->prefix.isIPv6 ? 128 : 32;
+	ciscoip_t broadcast;
+	ciscoconst_t retVar;
+
+	ciscoIPBroadcast(&pool->prefix, &broadcast);
+
+	// Skipped addresses stay allocated, so they're only skipped once
+	do {
+		retVar = ciscoPoolAllocate(pool, width, host);
+		if(retVar)
+			return retVar;
+	} while(pool->prefix.prefix < width - 1 && (memcmp(host->bytes, pool->prefix.bytes, 16) == 0 || (!host->isIPv6 && memcmp(host->bytes, broadcast.bytes, 16) == 0)));
+
+	host->prefix = pool->prefix.prefix;
+
+	return 0;
+}
+
+// Allocates a block of a prefix length from a pool for a link or a subnet and
+// gets the first address of it an interface can use: the block itself for
+// /31 and /127 links, the one after its network address otherwise
+ciscoconst_t ciscoPoolAllocateSubnet(ciscopool_t* pool, uint8_t prefix, ciscoip_t* address){
+	uint8_t width = pool->prefix.isIPv6 ? 128 : 32;
+	ciscoconst_t retVar = ciscoPoolAllocate(pool, prefix, address);
+	uint64_t halves[2];
+
+	if(retVar || prefix >= width - 1)
+		return retVar;
+
+	// The host bits of a new block are all clear, so this never carries
+	ciscoIPLoad(address->bytes, halves);
+	if(address->isIPv6)
+		halves[1] |= 1;
+	else
+		halves[0] |= (uint64_t)1 << 32;
+
+	ciscoIPStore(address->bytes, halves);
+
+	return 0;
+}
+
+// Marks a block of a pool as used, for addresses that were assigned by hand.
+// Returns CISCO_ERROR_CONFLICT if part of it was already handed out
+ciscoconst_t ciscoPoolReserve(ciscopool_t* pool, const ciscoip_t* block){
+	uint8_t current = pool->prefix.prefix;
+	uint32_t path[128];
+	uint64_t halves[2];
+	uint32_t index = 0;
+
+	if(block->prefix < current || !ciscoIPContains(&pool->prefix, block))
+		return CISCO_ERROR_OUT_OF_RANGE;
+
+	ciscoIPLoad(block->bytes, halves);
+
+	while(current < block->prefix){
+		if(ciscoPoolNode(pool, index)->maxFree == CISCO_POOL_FULL){
+			ciscoPoolUpdate(pool, path, current - pool->prefix.prefix);
+			return CISCO_ERROR_CONFLICT;
+		}
+
+		path[current - pool->prefix.prefix] = index;
+
+		if(!ciscoPoolNode(pool, index)->child[0] && ciscoPoolSplit(pool, index, current)){
+			ciscoPoolUpdate(pool, path, current - pool->prefix.prefix);
+			return CISCO_ERROR_PL32LIB_GC;
+		}
+
+		index = ciscoPoolNode(pool, index)->child[ciscoPoolBit(halves, current)];
+		current++;
+	}
+
+	// Splitting on the way down may have to be undone
+	if(ciscoPoolNode(pool, index)->maxFree != current){
+		ciscoPoolUpdate(pool, path, current - pool->prefix.prefix);
+		return CISCO_ERROR_CONFLICT;
+	}
+
+	ciscoPoolNode(pool, index)->maxFree = CISCO_POOL_FULL;
+	ciscoPoolUpdate(pool, path, current - pool->prefix.prefix);
+	pool->blocks++;
+
+	return 0;
+}
+
+// Returns a block handed out or reserved by a pool so it can be allocated
+// again. Returns CISCO_ERROR_INVALID_VALUE if it isn't one of its blocks
+ciscoconst_t ciscoPoolRelease(ciscopool_t* pool, const ciscoip_t* block){
+	uint8_t current = pool->prefix.prefix;
+	uint32_t path[128];
+	uint64_t halves[2];
+	uint32_t index = 0;
+
+	if(block->prefix < current || !ciscoIPContains(&pool->prefix, block))
+		return CISCO_ERROR_OUT_OF_RANGE;
+
+	ciscoIPLoad(block->bytes, halves);
+
+	while(current < block->prefix){
+		if(!ciscoPoolNode(pool, index)->child[0])
+			return CISCO_ERROR_INVALID_VALUE;
+
+		path[current - pool->prefix.prefix] = index;
+		index = ciscoPoolNode(pool, index)->child[ciscoPoolBit(halves, current)];
+		current++;
+	}
+
+	ciscopoolnode_t* node = ciscoPoolNode(pool, index);
+
+	if(node->child[0] || node->maxFree != CISCO_POOL_FULL)
+		return CISCO_ERROR_INVALID_VALUE;
+
+	node->maxFree = current;
+	ciscoPoolUpdate(pool, path, current - pool->prefix.prefix);
+	pool->blocks--;
+
+	return 0;
+}
+
+// Gets the name of an address pool
+const char* ciscoPoolGetName(ciscopool_t* pool){
+	return pool->name;
+}
+
+// Gets the prefix an address pool hands out blocks of
+const ciscoip_t* ciscoPoolGetPrefix(ciscopool_t* pool){
+	return &pool->prefix;
+}
+
+// Gets the amount of blocks an address pool has handed out or reserved
+size_t ciscoPoolGetBlocks(ciscopool_t* pool){
+	return pool->blocks;
+}
+
+// Frees an address pool
+void ciscoDestroyPool(ciscopool_t* pool){
+	ciscoVectorFree(&pool->nodes);
+	ciscoGCFree(pool->gc, pool->name);
+	ciscoGCFree(pool->gc, pool);
+}
+
+// Converts an interface constant into a string
+char* ciscoGenerateIntString(ciscoconst_t type, plgc_t* gc){
+	char* returnString = ciscoGCCalloc(gc, 5, sizeof(char));
+
+	switch(type){
+		case CISCO_INT_F0: ;
+			strcpy(returnString, "f0");
+			break;
+		case CISCO_INT_G0: ;
+			strcpy(returnString, "g0");
+			break;
+		case CISCO_INT_G00: ;
+			strcpy(returnString, "g0/0");
+			break;
+		case CISCO_INT_G01: ;
+			strcpy(returnString, "g0/1");
+			break;
+		case CISCO_INT_S00: ;
+			strcpy(returnString, "s0/0");
+			break;
+		case CISCO_INT_S01: ;
+			strcpy(returnString, "s0/1");
+			break;
+		case CISCO_INT_F1: ;
+			strcpy(returnString, "f1");
+			break;
+		case CISCO_INT_G1: ;
+			strcpy(returnString, "g1");
+			break;
+		case CISCO_INT_G10: ;
+			strcpy(returnString, "g1/0");
+			break;
+		case CISCO_INT_G11: ;
+			strcpy(returnString, "g1/1");
+			break;
+		default:
+			ciscoGCFree(gc, returnString);
+			returnString = NULL;
+	}
+
+	return returnString;
+}
+
+// Converts a string into an interface constant
+ciscoconst_t ciscoStringToIntType(char* string){
+	ciscointname_t name;
+	size_t amount;
+
+	if(ciscoParseIntNames(string, &name, 1, &amount))
+		return CISCO_ERROR_INVALID_VALUE;
+
+	for(int i = 0; i <= CISCO_INT_PORTCH; i++){
+		const ciscointname_t* legacy = &ciscoLegacyTypes[i];
+
+		if(legacy->media == name.media && legacy->depth == name.depth && (name.depth < 2 || legacy->slot == name.slot) && (name.depth < 3 || legacy->subslot == name.subslot))
+			return i;
+	}
+
+	return CISCO_ERROR_INVALID_VALUE;
+}
+
+// Looks up an interface media keyword (full or abbreviated, case insensitive)
+static int ciscoLookupMedia(const char* string, size_t size){
+	for(size_t i = 0; i < sizeof(ciscoMediaTable) / sizeof(ciscoMediaTable[0]); i++){
+		const char* name = ciscoMediaTable[i].name;
+		size_t j = 0;
+
+		if(size < ciscoMediaTable[i].minSize)
+			continue;
+
+		while(j < size && name[j] && tolower((unsigned char)string[j]) == name[j])
+			j++;
+
+		if(j == size)
+			return CISCO_MEDIA_FASTETH + i;
+	}
+
+	return -1;
+}
+
+// Parses an interface name or a comma-separated list of names and ranges
+// ("Gi1/0/24", "f0/1-4,f0/7-24", "Po2", "Vlan100") in a single pass without
+// allocating. List entries that start with a number reuse the previous media
+ciscoconst_t ciscoParseIntNames(const char* string, ciscointname_t* names, size_t maxNames, size_t* amount){
+	const char* pointer = string;
+	int media = -1;
+	size_t count = 0;
+
+	while(true){
+		ciscointname_t name;
+		uint32_t components[3];
+		uint8_t depth = 0;
+
+		if(isalpha((unsigned char)*pointer)){
+			const char* start = pointer;
+
+			while(isalpha((unsigned char)*pointer) || *pointer == '-')
+				pointer++;
+
+			media = ciscoLookupMedia(start, pointer - start);
+		}
+
+		if(media < 0)
+			return CISCO_ERROR_INVALID_VALUE;
+
+		while(true){
+			uint32_t value = 0;
+
+			if(!isdigit((unsigned char)*pointer) || depth == 3)
+				return CISCO_ERROR_INVALID_VALUE;
+
+			while(isdigit((unsigned char)*pointer)){
+				value = value * 10 + (*pointer - '0');
+				if(value > CISCO_VLAN_MAX)
+					return CISCO_ERROR_OUT_OF_RANGE;
+				pointer++;
+			}
+
+			components[depth] = value;
+			depth++;
+
+			if(*pointer != '/')
+				break;
+
+			pointer++;
+		}
+
+		if(depth < ciscoMediaTable[media - CISCO_MEDIA_FASTETH].minDepth || depth > ciscoMediaTable[media - CISCO_MEDIA_FASTETH].maxDepth)
+			return CISCO_ERROR_INVALID_VALUE;
+
+		if((depth > 1 && components[0] > 255) || (depth > 2 && components[1] > 255))
+			return CISCO_ERROR_OUT_OF_RANGE;
+
+		name.media = media;
+		name.depth = depth;
+		name.slot = depth > 1 ? components[0] : 0;
+		name.subslot = depth > 2 ? components[1] : 0;
+		name.port = components[depth - 1];
+		name.lastPort = name.port;
+
+		if(*pointer == '-'){
+			uint32_t value = 0;
+			pointer++;
+
+			if(!isdigit((unsigned char)*pointer))
+				return CISCO_ERROR_INVALID_VALUE;
+
+			while(isdigit((unsigned char)*pointer)){
+				value = value * 10 + (*pointer - '0');
+				if(value > CISCO_VLAN_MAX)
+					return CISCO_ERROR_OUT_OF_RANGE;
+				pointer++;
+			}
+
+			if(value < name.port)
+				return CISCO_ERROR_OUT_OF_RANGE;
+
+			name.lastPort = value;
+		}
+
+		if(count >= maxNames)
+			return CISCO_ERROR_BUFFER_OVERFLOW;
+
+		names[count] = name;
+		count++;
+
+		if(*pointer != ',')
+			break;
+
+		pointer++;
+	}
+
+	if(*pointer != '\0' && !isspace((unsigned char)*pointer))
+		return CISCO_ERROR_INVALID_VALUE;
+
+	*amount = count;
+	return 0;
+}
+
+// Writes the short form of an interface name ("g1/0/24", "f0/1-4", "po2") into
+// buffer, which must hold at least CISCO_INTNAME_MAXSIZE characters. Returns
+// the length of the string
+size_t ciscoFormatIntName(const ciscointname_t* name, char* buffer){
+	char* end = ciscoAppendIntName(buffer, name);
+
+	*end = '\0';
+	return end - buffer;
+}
+
+// Converts a mode constant into a static string. Returns NULL for modes that
+// have no keyword
+const char* ciscoModeToString(ciscoconst_t mode){
+	if(mode < CISCO_MODE_ACCESS || mode > CISCO_MODE_IN_PORTCH)
+		return NULL;
+
+	return ciscoModeTable[mode - CISCO_MODE_ACCESS];
+}
+
+// Converts a mode constant into a string
+char* ciscoGenerateModeString(ciscoconst_t mode, plgc_t* gc){
+	const char* modeString = ciscoModeToString(mode);
+
+	if(!modeString)
+		return NULL;
+
+	char* returnString = ciscoGCAlloc(gc, strlen(modeString) + 1);
+
+	if(returnString)
+		strcpy(returnString, modeString);
+
+	return returnString;
+}
+
+// Converts a string into a mode constant
+ciscoconst_t ciscoStringToMode(char* string){
+	for(int i = 0; ciscoModeTable[i]; i++){
+		if(strcmp(string, ciscoModeTable[i]) == 0)
+			return CISCO_MODE_ACCESS + i;
+	}
+
+	return CISCO_ERROR_INVALID_VALUE;
+}
+
+// Allocates memory for an interface structure and returns it
+ciscoint_t* ciscoCreateInterface(ciscoconst_t type, uint8_t port1, uint8_t port2, plgc_t* gc){
+	ciscointname_t name;
+
+	if(type > CISCO_INT_PORTCH)
+		return NULL;
+
+	name = ciscoLegacyTypes[type];
+	name.port = port1;
+	name.lastPort = port2 == 0 || port2 < port1 ? port1 : port2;
+
+	return ciscoCreateInterfaceFromName(&name, gc);
+}
+
+// Allocates memory for an interface structure with the given name and returns it
+ciscoint_t* ciscoCreateInterfaceFromName(const ciscointname_t* name, plgc_t* gc){
+	ciscoint_t* returnInt = ciscoGCAlloc(gc, sizeof(ciscoint_t));
+
+	if(!returnInt)
+		return NULL;
+
+	returnInt->name = *name;
+	returnInt->mode = CISCO_MODE_ACCESS;
+	returnInt->dirty = CISCO_DIRTY_ALL;
+	returnInt->snippet.data = NULL;
+	returnInt->snippet.size = 0;
+	returnInt->snippet.capacity = 0;
+	returnInt->description = NULL;
+	returnInt->allowedVlans = NULL;
+	returnInt->address = NULL;
+
+	return returnInt;
+}
+
+// Allocates memory for a table structure and returns it
+ciscotable_t* ciscoCreateTable(ciscoconst_t type, ciscoconst_t mode, uint16_t number, plgc_t* gc){
+	ciscotable_t* returnTable = ciscoGCAlloc(gc, sizeof(ciscotable_t));
+
+	returnTable->type = type;
+	returnTable->mode = mode;
+	for(int i = 0; i < 128; i++)
+		returnTable->name[i] = 0;
+	returnTable->number = number;
+	returnTable->dirty = CISCO_DIRTY_ALL;
+	returnTable->snippet.data = NULL;
+	returnTable->snippet.size = 0;
+	returnTable->snippet.capacity = 0;
+	returnTable->group.data = NULL;
+	returnTable->group.size = 0;
+	returnTable->group.capacity = 0;
+	returnTable->groupMembers = 0;
+	returnTable->groupCompact = false;
+	ciscoVectorInit(&returnTable->interfaces, sizeof(ciscoint_t*), 2, gc);
+
+	return returnTable;
+}
+
+// Gets the address block of an interface, allocating it on first use
+static ciscoaddr_t* ciscoGetAddress(ciscoint_t* interface, plgc_t* gc){
+	if(!interface->address){
+		interface->address = ciscoGCCalloc(gc, 1, sizeof(ciscoaddr_t));
+
+		if(interface->address)
+			interface->address->subMask = 24;
+	}
+
+	return interface->address;
+}
+
+// Modifies attributes in an interface. CISCO_MODTYPE_DESC copies the
+// description, CISCO_MODTYPE_DESC_INTERNED takes a ciscostrpool_t* after it
+// and interns it there instead
+ciscoconst_t ciscoModifyInterface(ciscoint_t* interface, plgc_t* gc, ciscoconst_t modType, ...){
+	va_list values;
+	va_start(values, modType);
+	ciscoconst_t constant = 0;
+	char* string = NULL;
+	ciscostrpool_t* pool = NULL;
+	ciscovlanset_t* vlanSet = NULL;
+	uint16_t numbers[2] = { 0, 0 };
+
+	// Type parser
+	switch(modType){
+		case CISCO_MODTYPE_TYPE: ;
+		case CISCO_MODTYPE_MODE: ;
+			constant = va_arg(values, int);
+			break;
+		case CISCO_MODTYPE_DESC_INTERNED: ;
+			string = va_arg(values, char*);
+			pool = va_arg(values, ciscostrpool_t*);
+			break;
+		case CISCO_MODTYPE_DESC: ;
+		case CISCO_MODTYPE_IP_ADDR: ;
+		case CISCO_MODTYPE_GATEWAY: ;
+			string = va_arg(values, char*);
+			break;
+		case CISCO_MODTYPE_ALLOW_VLAN_SET: ;
+			vlanSet = va_arg(values, ciscovlanset_t*);
+			break;
+		case CISCO_MODTYPE_PORTS: ;
+		case CISCO_MODTYPE_ALLOW_VLAN_RANGE: ;
+			numbers[0] = va_arg(values, int);
+		case CISCO_MODTYPE_ALLOW_VLAN: ;
+		case CISCO_MODTYPE_SUBMASK: ;
+			numbers[1] = va_arg(values, int);
+			break;
+		default:
+			return CISCO_ERROR_INVALID_ACTION;
+	}
+
+	// Action Parser
+	switch(modType){
+		case CISCO_MODTYPE_TYPE: ;
+			if(constant > CISCO_INT_VLAN)
+				return CISCO_ERROR_INVALID_VALUE;
+
+			numbers[0] = interface->name.port;
+			numbers[1] = interface->name.lastPort;
+			interface->name = ciscoLegacyTypes[constant];
+			interface->name.port = numbers[0];
+			interface->name.lastPort = numbers[1];
+			break;
+		case CISCO_MODTYPE_MODE: ;
+			if(interface->mode == CISCO_MODE_IN_PORTCH){
+				return CISCO_ERROR_INVALID_ACTION;
+			}else if(constant < CISCO_MODE_ACCESS || constant > CISCO_MODE_IN_PORTCH){
+				return CISCO_ERROR_INVALID_VALUE;
+			}
+
+			interface->mode = constant;
+			break;
+		case CISCO_MODTYPE_PORTS: ;
+			interface->name.port = numbers[0];
+			interface->name.lastPort = numbers[1] == 0 || numbers[1] < numbers[0] ? numbers[0] : numbers[1];
+			break;
+		case CISCO_MODTYPE_DESC: ;
+		case CISCO_MODTYPE_DESC_INTERNED: ;
+			if(strlen(string) > CISCO_DESC_MAXSIZE)
+				return CISCO_ERROR_BUFFER_OVERFLOW;
+
+			if(pool){
+				interface->description = ciscoStringPoolIntern(pool, string);
+			}else{
+				char* tempString = ciscoGCAlloc(gc, strlen(string) + 1);
+
+				if(tempString)
+					strcpy(tempString, string);
+
+				interface->description = tempString;
+			}
+
+			if(!interface->description)
+				return CISCO_ERROR_PL32LIB_GC;
+			break;
+		case CISCO_MODTYPE_ALLOW_VLAN: ;
+		case CISCO_MODTYPE_ALLOW_VLAN_RANGE: ;
+		case CISCO_MODTYPE_ALLOW_VLAN_SET: ;
+			if(modType == CISCO_MODTYPE_ALLOW_VLAN)
+				numbers[0] = numbers[1];
+
+			if(modType != CISCO_MODTYPE_ALLOW_VLAN_SET && (numbers[0] < 1 || numbers[1] > CISCO_VLAN_MAX || numbers[0] > numbers[1]))
+				return CISCO_ERROR_OUT_OF_RANGE;
+
+			if(!interface->allowedVlans){
+				interface->allowedVlans = ciscoGCAlloc(gc, sizeof(ciscovlanset_t));
+
+				if(!interface->allowedVlans)
+					return CISCO_ERROR_PL32LIB_GC;
+
+				ciscoVlanSetClear(interface->allowedVlans);
+			}
+
+			if(modType == CISCO_MODTYPE_ALLOW_VLAN_SET){
+				ciscoVlanSetUnion(interface->allowedVlans, vlanSet);
+			}else{
+				ciscoVlanSetAddRange(interface->allowedVlans, numbers[0], numbers[1]);
+			}
+			break;
+		case CISCO_MODTYPE_IP_ADDR: ;
+		case CISCO_MODTYPE_GATEWAY: ;
+			uint8_t otherFlag = modType == CISCO_MODTYPE_GATEWAY ? CISCO_ADDR_HAS_IP : CISCO_ADDR_HAS_GATEWAY;
+			bool hasPrefix = strchr(string, '/') != NULL;
+			ciscoip_t ip;
+			ciscoconst_t retVar = ciscoParseIP(string, &ip);
+
+			if(retVar)
+				return retVar;
+
+			// Only the interface address can carry a prefix length
+			if(hasPrefix && modType == CISCO_MODTYPE_GATEWAY)
+				return CISCO_ERROR_INVALID_VALUE;
+
+			uint8_t isIPv6 = ip.isIPv6 ? CISCO_ADDR_IPV6 : 0;
+
+			if(interface->address && (interface->address->flags & otherFlag) && (interface->address->flags & CISCO_ADDR_IPV6) != isIPv6)
+				return CISCO_ERROR_MISMATCHED_IPVER;
+
+			if(hasPrefix && ip.prefix > (ip.isIPv6 ? 128 : 32))
+				return CISCO_ERROR_OUT_OF_RANGE;
+
+			if(!ciscoGetAddress(interface, gc))
+				return CISCO_ERROR_PL32LIB_GC;
+
+			// A prefix length of the other family means nothing for this one
+			if((interface->address->flags & CISCO_ADDR_IPV6) != isIPv6)
+				interface->address->subMask = isIPv6 ? 64 : 24;
+
+			if(modType == CISCO_MODTYPE_GATEWAY){
+				memcpy(interface->address->gateway, ip.bytes, 16);
+				interface->address->flags |= CISCO_ADDR_HAS_GATEWAY;
+			}else{
+				memcpy(interface->address->ipAddr, ip.bytes, 16);
+				interface->address->flags |= CISCO_ADDR_HAS_IP;
+
+				if(hasPrefix)
+					interface->address->subMask = ip.prefix;
+			}
+
+			interface->address->flags = (interface->address->flags & ~CISCO_ADDR_IPV6) | isIPv6;
+			break;
+		case CISCO_MODTYPE_SUBMASK: ;
+			if(numbers[1] > ((interface->address && (interface->address->flags & CISCO_ADDR_IPV6)) ? 128 : 32))
+				return CISCO_ERROR_OUT_OF_RANGE;
+
+			if(!ciscoGetAddress(interface, gc))
+				return CISCO_ERROR_PL32LIB_GC;
+
+			interface->address->subMask = numbers[1];
+			break;
+	}
+
+	interface->dirty = CISCO_DIRTY_ALL;
+	return 0;
+}
+
+// Modifies attributes in a table
+ciscoconst_t ciscoModifyTable(ciscotable_t* table, plgc_t* gc, ciscoconst_t modType, ...){
+	va_list values;
+	va_start(values, modType);
+	ciscoconst_t constant;
+	char* string;
+
+	// Type parser
+	switch(modType){
+		case CISCO_MODTYPE_MODE: ;
+			constant = va_arg(values, int);
+			break;
+		case CISCO_MODTYPE_NAME: ;
+			string = va_arg(values, char*);
+			break;
+		default:
+			va_end(values);
+			return CISCO_ERROR_INVALID_ACTION;
+	}
+
+	va_end(values);
+
+	// Action Parser
+	switch(modType){
+		case CISCO_MODTYPE_MODE: ;
+			if(constant < CISCO_MODE_ACCESS || constant >= CISCO_MODE_IN_PORTCH)
+				return CISCO_ERROR_INVALID_VALUE;
+
+			table->mode = constant;
+			break;
+		case CISCO_MODTYPE_NAME: ;
+			if(strlen(string) + 1 > sizeof(table->name))
+				return CISCO_ERROR_BUFFER_OVERFLOW;
+
+			strcpy(table->name, string);
+			break;
+	}
+
+	table->dirty = CISCO_DIRTY_ALL;
+	return 0;
+}
+
+// Adds an interface to a table
+int ciscoAddInterface(ciscotable_t* table, ciscoint_t* interface, plgc_t* gc){
+	return ciscoAddInterfaces(table, &interface, 1, gc);
+}
+
+// Adds count interfaces to a table at once
+int ciscoAddInterfaces(ciscotable_t* table, ciscoint_t** interfaces, size_t count, plgc_t* gc){
+	if(ciscoVectorAppend(&table->interfaces, interfaces, count))
+		return CISCO_ERROR_PL32LIB_GC;
+
+	for(size_t i = 0; i < count; i++){
+		if(table->type == CISCO_INT_PORTCH)
+			interfaces[i]->mode = CISCO_MODE_IN_PORTCH;
+
+		interfaces[i]->dirty = CISCO_DIRTY_ALL;
+	}
+
+	return 0;
+}
+
+// Gets the packed name of an interface
+const ciscointname_t* ciscoGetInterfaceName(ciscoint_t* interface){
+	return &interface->name;
+}
+
+// Gets a pointer to an interface from a table
+ciscoint_t* ciscoGetInterface(ciscotable_t* table, int index){
+	if(index < 0 || index > table->interfaces.items.size-1){
+		return NULL;
+	}
+
+	return ((ciscoint_t**)table->interfaces.items.array)[index];
+}
+
+// Empties a VLAN set
+void ciscoVlanSetClear(ciscovlanset_t* set){
+	memset(set->bits, 0, sizeof(set->bits));
+}
+
+// Adds a single VLAN to a set
+void ciscoVlanSetAdd(ciscovlanset_t* set, uint16_t vlan){
+	if(vlan <= CISCO_VLAN_MAX)
+		set->bits[vlan >> 6] |= (uint64_t)1 << (vlan & 63);
+}
+
+// Adds every VLAN between first and last (inclusive) to a set, a word at a time
+void ciscoVlanSetAddRange(ciscovlanset_t* set, uint16_t first, uint16_t last){
+	if(last > CISCO_VLAN_MAX)
+		last = CISCO_VLAN_MAX;
+
+	if(first > last)
+		return;
+
+	size_t firstWord = first >> 6;
+	size_t lastWord = last >> 6;
+	uint64_t firstMask = ~(uint64_t)0 << (first & 63);
+	uint64_t lastMask = ~(uint64_t)0 >> (63 - (last & 63));
+
+	if(firstWord == lastWord){
+		set->bits[firstWord] |= firstMask & lastMask;
+		return;
+	}
+
+	set->bits[firstWord] |= firstMask;
+	for(size_t i = firstWord + 1; i < lastWord; i++)
+		set->bits[i] = ~(uint64_t)0;
+	set->bits[lastWord] |= lastMask;
+}
+
+// Removes a single VLAN from a set
+void ciscoVlanSetRemove(ciscovlanset_t* set, uint16_t vlan){
+	if(vlan <= CISCO_VLAN_MAX)
+		set->bits[vlan >> 6] &= ~((uint64_t)1 << (vlan & 63));
+}
+
+// Checks if a VLAN is in a set
+bool ciscoVlanSetTest(ciscovlanset_t* set, uint16_t vlan){
+	if(vlan > CISCO_VLAN_MAX)
+		return false;
+
+	return (set->bits[vlan >> 6] >> (vlan & 63)) & 1;
+}
+
+// dest = dest | src
+void ciscoVlanSetUnion(ciscovlanset_t* dest, ciscovlanset_t* src){
+	for(int i = 0; i < CISCO_VLANSET_WORDS; i++)
+		dest->bits[i] |= src->bits[i];
+}
+
+// dest = dest & src
+void ciscoVlanSetIntersect(ciscovlanset_t* dest, ciscovlanset_t* src){
+	for(int i = 0; i < CISCO_VLANSET_WORDS; i++)
+		dest->bits[i] &= src->bits[i];
+}
+
+// dest = every valid VLAN (1-4094) except the ones in src
+void ciscoVlanSetExcept(ciscovlanset_t* dest, ciscovlanset_t* src){
+	for(int i = 0; i < CISCO_VLANSET_WORDS; i++)
+		dest->bits[i] = ~src->bits[i];
+
+	dest->bits[0] &= ~(uint64_t)1;
+	dest->bits[CISCO_VLANSET_WORDS - 1] &= ~(uint64_t)0 >> (63 - (CISCO_VLAN_MAX & 63));
+}
+
+// Gets the amount of VLANs in a set
+size_t ciscoVlanSetCount(ciscovlanset_t* set){
+	size_t count = 0;
+
+	for(int i = 0; i < CISCO_VLANSET_WORDS; i++){
+		uint64_t word = set->bits[i];
+
+		while(word){
+			word &= word - 1;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+// Finds the first VLAN >= start whose membership equals state. Returns
+// CISCO_VLAN_MAX + 1 if there is none
+static uint16_t ciscoVlanSetScan(ciscovlanset_t* set, uint16_t start, bool state){
+	while(start <= CISCO_VLAN_MAX){
+		uint64_t word = state ? set->bits[start >> 6] : ~set->bits[start >> 6];
+		word &= ~(uint64_t)0 << (start & 63);
+
+		if(word){
+			uint16_t bit = 0;
+			while(!((word >> bit) & 1))
+				bit++;
+
+			start = (start & ~63) + bit;
+			return start > CISCO_VLAN_MAX ? CISCO_VLAN_MAX + 1 : start;
+		}
+
+		start = (start & ~63) + 64;
+	}
+
+	return CISCO_VLAN_MAX + 1;
+}
+
+// Parses a VLAN list such as "10-20,30,100-199" and adds it to a set
+ciscoconst_t ciscoVlanSetParse(ciscovlanset_t* set, const char* string){
+	const char* pointer = string;
+
+	while(*pointer){
+		char* endPtr;
+		long first = strtol(pointer, &endPtr, 10);
+		long last = first;
+
+		if(endPtr == pointer)
+			return CISCO_ERROR_INVALID_VALUE;
+
+		pointer = endPtr;
+		if(*pointer == '-'){
+			last = strtol(pointer + 1, &endPtr, 10);
+
+			if(endPtr == pointer + 1)
+				return CISCO_ERROR_INVALID_VALUE;
+
+			pointer = endPtr;
+		}
+
+		if(first < 1 || last > CISCO_VLAN_MAX || first > last)
+			return CISCO_ERROR_OUT_OF_RANGE;
+
+		ciscoVlanSetAddRange(set, first, last);
+
+		if(*pointer == ','){
+			pointer++;
+		}else if(*pointer != '\0'){
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+	}
+
+	return 0;
+}
+
+// Appends a VLAN set as a compact range list ("10-20,30,100-199")
+static char* ciscoAppendVlanSet(char* dest, ciscovlanset_t* set){
+	uint16_t first = ciscoVlanSetScan(set, 1, true);
+	bool isFirst = true;
+
+	while(first <= CISCO_VLAN_MAX){
+		uint16_t last = ciscoVlanSetScan(set, first, false) - 1;
+
+		if(!isFirst){
+			*dest = ',';
+			dest++;
+		}
+
+		dest = ciscoAppendUint(dest, first);
+		if(first != last){
+			*dest = '-';
+			dest = ciscoAppendUint(dest + 1, last);
+		}
+
+		isFirst = false;
+
+		if(last >= CISCO_VLAN_MAX)
+			break;
+
+		first = ciscoVlanSetScan(set, last + 1, true);
+	}
+
+	return dest;
+}
+
+// Renders a VLAN set as a compact range list ("10-20,30,100-199") into a sink
+ciscoconst_t ciscoVlanSetFormat(ciscovlanset_t* set, ciscosink_t* sink){
+	char buffer[CISCO_VLANSET_MAXSTRING];
+	char* end = ciscoAppendVlanSet(buffer, set);
+
+	return ciscoSinkWrite(sink, buffer, end - buffer);
+}
+
+// FNV-1a hash used by the string pool
+static uint32_t ciscoHashString(const char* string){
+	uint32_t hash = 2166136261u;
+
+	while(*string){
+		hash ^= (uint8_t)*string;
+		hash *= 16777619u;
+		string++;
+	}
+
+	return hash;
+}
+
+// Allocates memory for an empty interned string pool and returns it
+ciscostrpool_t* ciscoCreateStringPool(plgc_t* gc){
+	ciscostrpool_t* returnPool = ciscoGCAlloc(gc, sizeof(ciscostrpool_t));
+
+	if(!returnPool)
+		return NULL;
+
+	returnPool->capacity = 64;
+	returnPool->size = 0;
+	returnPool->slots = ciscoGCCalloc(gc, returnPool->capacity, sizeof(char*));
+	returnPool->chunk = NULL;
+	returnPool->chunkUsed = CISCO_STRPOOL_CHUNKSIZE;
+	returnPool->gc = gc;
+
+	if(!returnPool->slots){
+		ciscoGCFree(gc, returnPool);
+		return NULL;
+	}
+
+	return returnPool;
+}
+
+// Returns the pooled copy of a string, storing it first if it isn't in the pool.
+// Identical strings always return the same pointer
+const char* ciscoStringPoolIntern(ciscostrpool_t* pool, const char* string){
+	size_t mask = pool->capacity - 1;
+	size_t index = ciscoHashString(string) & mask;
+
+	while(pool->slots[index]){
+		if(strcmp(pool->slots[index], string) == 0)
+			return pool->slots[index];
+
+		index = (index + 1) & mask;
+	}
+
+	// Keep the load factor under 3/4
+	if((pool->size + 1) * 4 > pool->capacity * 3){
+		size_t newCapacity = pool->capacity * 2;
+		char** newSlots = ciscoGCCalloc(pool->gc, newCapacity, sizeof(char*));
+
+		if(!newSlots)
+			return NULL;
+
+		for(size_t i = 0; i < pool->capacity; i++){
+			if(pool->slots[i]){
+				size_t newIndex = ciscoHashString(pool->slots[i]) & (newCapacity - 1);
+
+				while(newSlots[newIndex])
+					newIndex = (newIndex + 1) & (newCapacity - 1);
+
+				newSlots[newIndex] = pool->slots[i];
+			}
+		}
+
+		ciscoGCFree(pool->gc, pool->slots);
+		pool->slots = newSlots;
+		pool->capacity = newCapacity;
+		mask = newCapacity - 1;
+		index = ciscoHashString(string) & mask;
+
+		while(pool->slots[index])
+			index = (index + 1) & mask;
+	}
+
+	size_t strSize = strlen(string) + 1;
+	char* storedString;
+
+	// Strings are packed into shared chunks, only oversized ones get their own block
+	if(strSize > CISCO_STRPOOL_CHUNKSIZE / 4){
+		storedString = ciscoGCAlloc(pool->gc, strSize);
+	}else{
+		if(pool->chunkUsed + strSize > CISCO_STRPOOL_CHUNKSIZE){
+			pool->chunk = ciscoGCAlloc(pool->gc, CISCO_STRPOOL_CHUNKSIZE);
+
+			if(!pool->chunk){
+				pool->chunkUsed = CISCO_STRPOOL_CHUNKSIZE;
+				return NULL;
+			}
+
+			pool->chunkUsed = 0;
+		}
+
+		storedString = pool->chunk + pool->chunkUsed;
+		pool->chunkUsed += strSize;
+	}
+
+	if(!storedString)
+		return NULL;
+
+	memcpy(storedString, string, strSize);
+	pool->slots[index] = storedString;
+	pool->size++;
+
+	return storedString;
+}
+
+// Gets the amount of distinct strings stored in a pool
+size_t ciscoStringPoolSize(ciscostrpool_t* pool){
+	return pool->size;
+}
+
+// Packs an interface name into an integer that sorts in the same order as
+// the names themselves. The last port of a range is not included
+static uint64_t ciscoPackIntName(const ciscointname_t* name){
+	return (uint64_t)name->media << 56 | (uint64_t)name->depth << 48 | (uint64_t)name->slot << 40 | (uint64_t)name->subslot << 32 | name->port;
+}
+
+// Allocates memory for an empty port ownership index and returns it
+ciscoportindex_t* ciscoCreatePortIndex(plgc_t* gc){
+	ciscoportindex_t* returnIndex = ciscoGCAlloc(gc, sizeof(ciscoportindex_t));
+
+	if(!returnIndex)
+		return NULL;
+
+	returnIndex->slotCount = 16;
+	returnIndex->moduleCount = 0;
+	returnIndex->slots = ciscoGCCalloc(gc, returnIndex->slotCount, sizeof(ciscoportmodule_t*));
+	returnIndex->gc = gc;
+
+	if(!returnIndex->slots){
+		ciscoGCFree(gc, returnIndex);
+		return NULL;
+	}
+
+	return returnIndex;
+}
+
+// Gets the port index slot of a module. The slot is empty if no port of the
+// module was claimed yet
+static ciscoportmodule_t** ciscoPortModuleSlot(ciscoportindex_t* index, uint32_t key){
+	size_t mask = index->slotCount - 1;
+	size_t slot = ((uint64_t)key * 0x9e3779b97f4a7c15ULL) >> 32 & mask;
+
+	while(index->slots[slot] && index->slots[slot]->key != key)
+		slot = (slot + 1) & mask;
+
+	return &index->slots[slot];
+}
+
+// Gets the module of a port, creating it if needed and making sure it covers
+// the port
+static ciscoportmodule_t* ciscoPortModule(ciscoportindex_t* index, const ciscointname_t* name){
+	uint32_t key = ciscoPackIntName(name) >> 32;
+	ciscoportmodule_t** slot = ciscoPortModuleSlot(index, key);
+	ciscoportmodule_t* module = *slot;
+
+	if(!module){
+		// Keep the load factor under 3/4
+		if((index->moduleCount + 1) * 4 > index->slotCount * 3){
+			ciscoportmodule_t** oldSlots = index->slots;
+			size_t oldCount = index->slotCount;
+			ciscoportmodule_t** newSlots = ciscoGCCalloc(index->gc, oldCount * 2, sizeof(ciscoportmodule_t*));
+
+			if(!newSlots)
+				return NULL;
+
+			index->slots = newSlots;
+			index->slotCount = oldCount * 2;
+
+			for(size_t i = 0; i < oldCount; i++){
+				if(oldSlots[i])
+					*ciscoPortModuleSlot(index, oldSlots[i]->key) = oldSlots[i];
+			}
+
+			ciscoGCFree(index->gc, oldSlots);
+			slot = ciscoPortModuleSlot(index, key);
+		}
+
+		module = ciscoGCCalloc(index->gc, 1, sizeof(ciscoportmodule_t));
+		if(!module)
+			return NULL;
+
+		module->key = key;
+		*slot = module;
+		index->moduleCount++;
+	}
+
+	if(name->port >= module->portCount){
+		size_t newCount = module->portCount ? module->portCount : CISCO_PORTINDEX_MINPORTS;
+
+		while(newCount <= name->port)
+			newCount *= 2;
+
+		uint64_t* configured = ciscoGCRealloc(index->gc, module->configured, newCount / 64 * sizeof(uint64_t));
+		if(!configured)
+			return NULL;
+
+		module->configured = configured;
+
+		uint16_t* vlan = ciscoGCRealloc(index->gc, module->vlan, newCount * sizeof(uint16_t));
+		if(!vlan)
+			return NULL;
+
+		module->vlan = vlan;
+
+		uint16_t* channel = ciscoGCRealloc(index->gc, module->channel, newCount * sizeof(uint16_t));
+		if(!channel)
+			return NULL;
+
+		module->channel = channel;
+		memset(module->configured + module->portCount / 64, 0, (newCount - module->portCount) / 64 * sizeof(uint64_t));
+		memset(module->vlan + module->portCount, 0, (newCount - module->portCount) * sizeof(uint16_t));
+		memset(module->channel + module->portCount, 0, (newCount - module->portCount) * sizeof(uint16_t));
+		module->portCount = newCount;
+	}
+
+	return module;
+}
+
+// Checks whether a port can be claimed by a table, or configured with int if
+// table is NULL. Returns true and fills in conflict if it can't
+static bool ciscoPortConflicts(ciscoportmodule_t* module, const ciscotable_t* table, const ciscointname_t* name, ciscoportconflict_t* conflict){
+	uint16_t port = name->port;
+	ciscoconst_t type = 0;
+	uint16_t number = 0;
+
+	if(!module || port >= module->portCount)
+		return false;
+
+	if(!table){
+		if(!(module->configured[port / 64] & (1ULL << (port % 64))))
+			return false;
+	}else if(table->type == CISCO_INT_VLAN){
+		if(!module->vlan[port] || module->vlan[port] == table->number)
+			return false;
+
+		type = CISCO_INT_VLAN;
+		number = module->vlan[port];
+	}else{
+		if(!module->channel[port] || module->channel[port] == table->number)
+			return false;
+
+		type = CISCO_INT_PORTCH;
+		number = module->channel[port];
+	}
+
+	if(conflict){
+		conflict->name = *name;
+		conflict->name.lastPort = port;
+		conflict->type = type;
+		conflict->number = number;
+	}
+
+	return true;
+}
+
+// Gives back the ports configured with int by a ciscoPortIndexClaim() call
+// that failed, from the first interface up to the given one and port
+static void ciscoPortIndexRelease(ciscoportindex_t* index, ciscoint_t** interfaces, size_t last, uint32_t lastPort){
+	for(size_t i = 0; i <= last; i++){
+		ciscointname_t name = interfaces[i]->name;
+		uint32_t end = i == last ? lastPort : (uint32_t)interfaces[i]->name.lastPort + 1;
+
+		for(uint32_t port = interfaces[i]->name.port; port < end; port++){
+			name.port = port;
+			ciscoportmodule_t* module = *ciscoPortModuleSlot(index, ciscoPackIntName(&name) >> 32);
+
+			module->configured[port / 64] &= ~(1ULL << (port % 64));
+		}
+	}
+}
+
+// Claims every port of count interfaces for a table, or for int if table is
+// NULL. Ports that are trunk members of a VLAN aren't claimed, as a trunk
+// carries any amount of VLANs. Either every port is claimed or, if one of them
+// conflicts, none of them is
+ciscoconst_t ciscoPortIndexClaim(ciscoportindex_t* index, const ciscotable_t* table, ciscoint_t** interfaces, size_t count, ciscoportconflict_t* conflict){
+	bool isVlan = table && table->type == CISCO_INT_VLAN;
+
+	// Ports already claimed before this call can't be claimed at all
+	for(size_t i = 0; i < count; i++){
+		ciscointname_t name = interfaces[i]->name;
+		ciscoportmodule_t* module = *ciscoPortModuleSlot(index, ciscoPackIntName(&name) >> 32);
+
+		if(isVlan && interfaces[i]->mode == CISCO_MODE_TRUNK)
+			continue;
+
+		for(uint32_t port = interfaces[i]->name.port; port <= interfaces[i]->name.lastPort; port++){
+			name.port = port;
+
+			if(ciscoPortConflicts(module, table, &name, conflict))
+				return CISCO_ERROR_CONFLICT;
+		}
+	}
+
+	for(size_t i = 0; i < count; i++){
+		ciscointname_t name = interfaces[i]->name;
+
+		if(isVlan && interfaces[i]->mode == CISCO_MODE_TRUNK)
+			continue;
+
+		for(uint32_t port = interfaces[i]->name.port; port <= interfaces[i]->name.lastPort; port++){
+			name.port = port;
+
+			ciscoportmodule_t* module = ciscoPortModule(index, &name);
+			if(!module)
+				return CISCO_ERROR_PL32LIB_GC;
+
+			if(table){
+				if(isVlan){
+					module->vlan[port] = table->number;
+				}else{
+					module->channel[port] = table->number;
+				}
+
+				continue;
+			}
+
+			// The same port listed twice by int only shows up here, and
+			// everything this call configured is given back
+			if(ciscoPortConflicts(module, NULL, &name, conflict)){
+				ciscoPortIndexRelease(index, interfaces, i, port);
+				return CISCO_ERROR_CONFLICT;
+			}
+
+			module->configured[port / 64] |= 1ULL << (port % 64);
+		}
+	}
+
+	return 0;
+}
+
+// Claims every member port of a table
+ciscoconst_t ciscoPortIndexAddTable(ciscoportindex_t* index, const ciscotable_t* table, ciscoportconflict_t* conflict){
+	return ciscoPortIndexClaim(index, table, table->interfaces.items.array, table->interfaces.items.size, conflict);
+}
+
+// Frees a port ownership index
+void ciscoDestroyPortIndex(ciscoportindex_t* index){
+	for(size_t i = 0; i < index->slotCount; i++){
+		ciscoportmodule_t* module = index->slots[i];
+
+		if(!module)
+			continue;
+
+		ciscoGCFree(index->gc, module->configured);
+		ciscoGCFree(index->gc, module->vlan);
+		ciscoGCFree(index->gc, module->channel);
+		ciscoGCFree(index->gc, module);
+	}
+
+	ciscoGCFree(index->gc, index->slots);
+	ciscoGCFree(index->gc, index);
+}
+ciscomodel_t* ciscoCreateModel(plgc_t* gc){
+	ciscomodel_t* returnModel = ciscoGCAlloc(gc, sizeof(ciscomodel_t));
+
+	ciscoVectorInit(&returnModel->interfaces, sizeof(ciscoint_t*), 2, gc);
+	ciscoVectorInit(&returnModel->tables, sizeof(ciscotable_t*), 2, gc);
+	returnModel->tableSlotCount = 16;
+	returnModel->tableSlots = ciscoGCCalloc(gc, returnModel->tableSlotCount, sizeof(ciscotable_t*));
+	returnModel->indexedTables = 0;
+	returnModel->ports = ciscoCreatePortIndex(gc);
+	memset(&returnModel->conflict, 0, sizeof(ciscoportconflict_t));
+	ciscoVectorInit(&returnModel->pools, sizeof(ciscopool_t*), 0, gc);
+	ciscoVectorInit(&returnModel->profiles, sizeof(ciscoprofile_t*), 0, gc);
+	ciscoVectorInit(&returnModel->profileRanges, sizeof(ciscoprofilerange_t*), 0, gc);
+	ciscoVectorInit(&returnModel->sortedRanges, sizeof(ciscoprofilerange_t*), 0, gc);
+	returnModel->misc.line_passwd = NULL;
+	returnModel->misc.enable_passwd = NULL;
+	returnModel->misc.enable_secret = NULL;
+	returnModel->misc.hostname = NULL;
+	returnModel->strings = ciscoCreateStringPool(gc);
+	returnModel->scratch = NULL;
+	memset(&returnModel->standalone, 0, sizeof(ciscosnippet_t));
+	returnModel->standaloneCount = 0;
+	returnModel->standaloneCompact = false;
+	returnModel->standaloneCached = false;
+	returnModel->mapping = NULL;
+	returnModel->mappingSize = 0;
+	returnModel->gc = gc;
+
+	return returnModel;
+}
+
+// Adds a standalone interface to a model
+int ciscoModelAddInterface(ciscomodel_t* model, ciscoint_t* interface){
+	return ciscoModelAddInterfaces(model, &interface, 1);
+}
+
+// Adds count standalone interfaces to a model at once. Returns
+// CISCO_ERROR_CONFLICT without adding any of them if one of their ports was
+// already configured, see ciscoModelGetConflict()
+int ciscoModelAddInterfaces(ciscomodel_t* model, ciscoint_t** interfaces, size_t count){
+	ciscoconst_t retVar = ciscoPortIndexClaim(model->ports, NULL, interfaces, count, &model->conflict);
+
+	if(retVar)
+		return retVar;
+
+	return ciscoVectorAppend(&model->interfaces, interfaces, count);
+}
+
+// Adds count interfaces to a table of a model at once. Returns
+// CISCO_ERROR_CONFLICT without adding any of them if one of their ports
+// already belongs to another VLAN or EtherChannel
+int ciscoModelAddTableInterfaces(ciscomodel_t* model, ciscotable_t* table, ciscoint_t** interfaces, size_t count){
+	ciscoconst_t retVar = ciscoPortIndexClaim(model->ports, table, interfaces, count, &model->conflict);
+
+	if(retVar)
+		return retVar;
+
+	return ciscoAddInterfaces(table, interfaces, count, model->gc);
+}
+
+// Gets the port of the last conflict reported by a model and what it was
+// already configured as
+const ciscoportconflict_t* ciscoModelGetConflict(ciscomodel_t* model){
+	return &model->conflict;
+}
+
+// Adds an address pool to a model. Returns CISCO_ERROR_CONFLICT if the model
+// already has a pool with the same name
+int ciscoModelAddPool(ciscomodel_t* model, ciscopool_t* pool){
+	if(ciscoModelFindPool(model, pool->name))
+		return CISCO_ERROR_CONFLICT;
+
+	return ciscoVectorPush(&model->pools, &pool);
+}
+
+// Finds an address pool of a model by name. Returns NULL if there is none
+ciscopool_t* ciscoModelFindPool(ciscomodel_t* model, const char* name){
+	ciscopool_t** pools = model->pools.items.array;
+
+	for(size_t i = 0; i < model->pools.items.size; i++){
+		if(strcmp(pools[i]->name, name) == 0)
+			return pools[i];
+	}
+
+	return NULL;
+}
+
+// Copies port settings into ones owned by a model. Descriptions are interned
+// and VLAN sets are copied
+static ciscoconst_t ciscoCopyPortSettings(ciscomodel_t* model, ciscoportsettings_t* dest, const ciscoportsettings_t* src){
+	if(src->mode && src->mode != CISCO_MODE_ACCESS && src->mode != CISCO_MODE_TRUNK)
+		return CISCO_ERROR_INVALID_VALUE;
+
+	if(src->vlan > CISCO_VLAN_MAX)
+		return CISCO_ERROR_OUT_OF_RANGE;
+
+	if(src->description && strlen(src->description) > CISCO_DESC_MAXSIZE)
+		return CISCO_ERROR_BUFFER_OVERFLOW;
+
+	dest->mode = src->mode;
+	dest->vlan = src->vlan;
+	dest->description = NULL;
+	dest->allowedVlans = NULL;
+
+	if(src->description){
+		dest->description = ciscoStringPoolIntern(model->strings, src->description);
+		if(!dest->description)
+			return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	if(src->allowedVlans){
+		ciscovlanset_t* set = ciscoGCAlloc(model->gc, sizeof(ciscovlanset_t));
+
+		if(!set)
+			return CISCO_ERROR_PL32LIB_GC;
+
+		*set = *src->allowedVlans;
+		dest->allowedVlans = set;
+	}
+
+	return 0;
+}
+
+// Adds a named port profile to a model. Profiles only hold switchport
+// settings, so the mode is access, trunk or unset. Returns
+// CISCO_ERROR_CONFLICT if the model already has a profile with that name
+int ciscoModelAddProfile(ciscomodel_t* model, const char* name, const ciscoportsettings_t* settings){
+	if(ciscoModelFindProfile(model, name))
+		return CISCO_ERROR_CONFLICT;
+
+	ciscoprofile_t* profile = ciscoGCAlloc(model->gc, sizeof(ciscoprofile_t));
+
+	if(!profile)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	profile->name = ciscoStringPoolIntern(model->strings, name);
+	ciscoconst_t retVar = ciscoCopyPortSettings(model, &profile->settings, settings);
+
+	if(!retVar && !profile->name)
+		retVar = CISCO_ERROR_PL32LIB_GC;
+
+	if(!retVar)
+		retVar = ciscoVectorPush(&model->profiles, &profile);
+
+	if(retVar)
+		ciscoGCFree(model->gc, profile);
+
+	return retVar;
+}
+
+// Finds a port profile of a model by name. Returns NULL if there is none
+ciscoprofile_t* ciscoModelFindProfile(ciscomodel_t* model, const char* name){
+	ciscoprofile_t** profiles = model->profiles.items.array;
+
+	for(size_t i = 0; i < model->profiles.items.size; i++){
+		if(strcmp(profiles[i]->name, name) == 0)
+			return profiles[i];
+	}
+
+	return NULL;
+}
+
+// Finds the position of the first profile range that starts after a packed
+// port name in the ranges of a model sorted by module and first port
+static size_t ciscoSortedRangePosition(ciscomodel_t* model, uint64_t key){
+	ciscoprofilerange_t** ranges = model->sortedRanges.items.array;
+	size_t low = 0;
+	size_t high = model->sortedRanges.items.size;
+
+	while(low < high){
+		size_t middle = low + (high - low) / 2;
+
+		if(ciscoPackIntName(&ranges[middle]->name) <= key)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+// Applies a port profile to count interface names of a model. Every name is
+// kept as one range however many ports it has. The ports are claimed like
+// standalone interfaces, so it returns CISCO_ERROR_CONFLICT without applying
+// anything if one of them was already configured
+int ciscoModelApplyProfile(ciscomodel_t* model, ciscoprofile_t* profile, const ciscointname_t* names, size_t count){
+	ciscoint_t* stubs = ciscoGCCalloc(model->gc, count + 1, sizeof(ciscoint_t));
+	ciscoint_t** stubPtrs = ciscoGCAlloc(model->gc, (count + 1) * sizeof(ciscoint_t*));
+	ciscoconst_t retVar = 0;
+
+	if(!stubs || !stubPtrs)
+		retVar = CISCO_ERROR_PL32LIB_GC;
+
+	for(size_t i = 0; !retVar && i < count; i++){
+		stubs[i].name = names[i];
+		stubPtrs[i] = &stubs[i];
+	}
+
+	if(!retVar)
+		retVar = ciscoPortIndexClaim(model->ports, NULL, stubPtrs, count, &model->conflict);
+
+	for(size_t i = 0; !retVar && i < count; i++){
+		ciscoprofilerange_t* range = ciscoGCAlloc(model->gc, sizeof(ciscoprofilerange_t));
+
+		if(!range){
+			retVar = CISCO_ERROR_PL32LIB_GC;
+			break;
+		}
+
+		range->name = names[i];
+		range->profile = profile;
+		ciscoVectorInit(&range->overrides, sizeof(ciscoportoverride_t), 0, model->gc);
+		retVar = ciscoVectorPush(&model->profileRanges, &range);
+
+		// Ranges are rendered in the order they were applied, but looked up
+		// by port through a copy sorted by module and first port
+		size_t position = ciscoSortedRangePosition(model, ciscoPackIntName(&range->name));
+
+		if(!retVar)
+			retVar = ciscoVectorPush(&model->sortedRanges, &range);
+
+		if(!retVar){
+			ciscoprofilerange_t** sorted = model->sortedRanges.items.array;
+
+			memmove(sorted + position + 1, sorted + position, (model->sortedRanges.items.size - position - 1) * sizeof(ciscoprofilerange_t*));
+			sorted[position] = range;
+		}
+	}
+
+	ciscoGCFree(model->gc, stubs);
+	ciscoGCFree(model->gc, stubPtrs);
+
+	return retVar;
+}
+
+// Finds the override of a port of a profile range. Returns NULL if the port
+// only has the settings of its profile
+static ciscoportoverride_t* ciscoFindOverride(ciscoprofilerange_t* range, uint16_t port, size_t* position){
+	ciscoportoverride_t* overrides = range->overrides.items.array;
+	size_t low = 0;
+	size_t high = range->overrides.items.size;
+
+	while(low < high){
+		size_t middle = low + (high - low) / 2;
+
+		if(overrides[middle].port < port)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(position)
+		*position = low;
+
+	return low < range->overrides.items.size && overrides[low].port == port ? &overrides[low] : NULL;
+}
+
+// Finds the profile range a port belongs to. Returns NULL if it has none.
+// Ranges claim their ports, so they never overlap and the only candidate is
+// the last one of the module that starts at or before the port
+static ciscoprofilerange_t* ciscoFindProfileRange(ciscomodel_t* model, const ciscointname_t* name, uint16_t port){
+	ciscoprofilerange_t** ranges = model->sortedRanges.items.array;
+	ciscointname_t portName = *name;
+
+	portName.port = port;
+
+	uint64_t key = ciscoPackIntName(&portName);
+	size_t position = ciscoSortedRangePosition(model, key);
+
+	if(!position)
+		return NULL;
+
+	ciscoprofilerange_t* range = ranges[position - 1];
+
+	if(ciscoPackIntName(&range->name) >> 32 != key >> 32 || port > range->name.lastPort)
+		return NULL;
+
+	return range;
+}
+
+// Overrides settings of the ports of count interface names that got their
+// settings from a profile. Only the settings that are set replace the ones
+// of the profile, and overriding a port again adds to its earlier overrides.
+// Returns CISCO_ERROR_INVALID_ACTION without changing anything if one of the
+// ports has no profile
+int ciscoModelOverridePorts(ciscomodel_t* model, const ciscointname_t* names, size_t count, const ciscoportsettings_t* settings){
+	ciscoportsettings_t copy;
+
+	// A range covers every port up to its last one, so it's only looked up
+	// again past it
+	for(size_t i = 0; i < count; i++){
+		ciscoprofilerange_t* range = NULL;
+
+		for(uint32_t port = names[i].port; port <= names[i].lastPort; port++){
+			if(!range || port > range->name.lastPort)
+				range = ciscoFindProfileRange(model, &names[i], port);
+
+			if(!range)
+				return CISCO_ERROR_INVALID_ACTION;
+		}
+	}
+
+	ciscoconst_t retVar = ciscoCopyPortSettings(model, &copy, settings);
+
+	for(size_t i = 0; !retVar && i < count; i++){
+		ciscoprofilerange_t* range = NULL;
+
+		for(uint32_t port = names[i].port; port <= names[i].lastPort; port++){
+			if(!range || port > range->name.lastPort)
+				range = ciscoFindProfileRange(model, &names[i], port);
+
+			size_t position = 0;
+			ciscoportoverride_t* override = ciscoFindOverride(range, port, &position);
+
+			// Overrides stay sorted, so new ones are moved into place
+			if(!override){
+				ciscoportoverride_t empty;
+
+				memset(&empty, 0, sizeof(ciscoportoverride_t));
+				empty.port = port;
+
+				if(ciscoVectorPush(&range->overrides, &empty))
+					return CISCO_ERROR_PL32LIB_GC;
+
+				override = (ciscoportoverride_t*)range->overrides.items.array + position;
+				memmove(override + 1, override, (range->overrides.items.size - position - 1) * sizeof(ciscoportoverride_t));
+				*override = empty;
+			}
+
+			if(copy.mode)
+				override->settings.mode = copy.mode;
+
+			if(copy.vlan)
+				override->settings.vlan = copy.vlan;
+
+			if(copy.description)
+				override->settings.description = copy.description;
+
+			if(copy.allowedVlans)
+				override->settings.allowedVlans = copy.allowedVlans;
+		}
+	}
+
+	return retVar;
+}
+
+// Hashes the type and number of a table for the table index
+static size_t ciscoHashTable(ciscoconst_t type, uint16_t number){
+	uint64_t key = ((uint64_t)type << 16) | number;
+
+	return (key * 0x9e3779b97f4a7c15ULL) >> 32;
+}
+
+// Gets the table index slot of a type and number. The slot is empty if the
+// model has no such table
+static ciscotable_t** ciscoTableSlot(ciscomodel_t* model, ciscoconst_t type, uint16_t number){
+	size_t mask = model->tableSlotCount - 1;
+	size_t index = ciscoHashTable(type, number) & mask;
+
+	while(model->tableSlots[index] && (model->tableSlots[index]->type != type || model->tableSlots[index]->number != number))
+		index = (index + 1) & mask;
+
+	return &model->tableSlots[index];
+}
+
+// Adds a table to the table index of a model, unless the model already has a
+// table with the same type and number
+static ciscoconst_t ciscoIndexTable(ciscomodel_t* model, ciscotable_t* table){
+	// Keep the load factor under 3/4
+	if((model->indexedTables + 1) * 4 > model->tableSlotCount * 3){
+		ciscotable_t** oldSlots = model->tableSlots;
+		size_t oldCount = model->tableSlotCount;
+		ciscotable_t** newSlots = ciscoGCCalloc(model->gc, oldCount * 2, sizeof(ciscotable_t*));
+
+		if(!newSlots)
+			return CISCO_ERROR_PL32LIB_GC;
+
+		model->tableSlots = newSlots;
+		model->tableSlotCount = oldCount * 2;
+
+		for(size_t i = 0; i < oldCount; i++){
+			if(oldSlots[i])
+				*ciscoTableSlot(model, oldSlots[i]->type, oldSlots[i]->number) = oldSlots[i];
+		}
+
+		ciscoGCFree(model->gc, oldSlots);
+	}
+
+	ciscotable_t** slot = ciscoTableSlot(model, table->type, table->number);
+
+	if(!*slot){
+		*slot = table;
+		model->indexedTables++;
+	}
+
+	return 0;
+}
+
+// Adds a table to a model. Tables are looked up by type and number, and if
+// the model already has a table like this one, the first of them is the one
+// ciscoModelFindTable() returns
+int ciscoModelAddTable(ciscomodel_t* model, ciscotable_t* table){
+	ciscoconst_t retVar = ciscoPortIndexAddTable(model->ports, table, &model->conflict);
+
+	if(retVar)
+		return retVar;
+
+	if(ciscoIndexTable(model, table))
+		return CISCO_ERROR_PL32LIB_GC;
+
+	return ciscoVectorPush(&model->tables, &table);
+}
+
+// Adds count tables to a model at once
+int ciscoModelAddTables(ciscomodel_t* model, ciscotable_t** tables, size_t count){
+	for(size_t i = 0; i < count; i++){
+		ciscoconst_t retVar = ciscoPortIndexAddTable(model->ports, tables[i], &model->conflict);
+
+		if(retVar)
+			return retVar;
+
+		if(ciscoIndexTable(model, tables[i]))
+			return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	return ciscoVectorAppend(&model->tables, tables, count);
+}
+
+// Finds the table of a model with a type and number, or returns NULL if the
+// model has none
+ciscotable_t* ciscoModelFindTable(ciscomodel_t* model, ciscoconst_t type, uint16_t number){
+	return *ciscoTableSlot(model, type, number);
+}
+
+// Gets the table of a model with a type and number, creating an empty one in
+// the given mode and adding it to the model if there isn't one yet
+ciscotable_t* ciscoModelGetTable(ciscomodel_t* model, ciscoconst_t type, uint16_t number, ciscoconst_t mode){
+	ciscotable_t* table = ciscoModelFindTable(model, type, number);
+
+	if(table)
+		return table;
+
+	table = ciscoCreateTable(type, mode, number, model->gc);
+	if(!table || ciscoModelAddTable(model, table))
+		return NULL;
+
+	return table;
+}
+
+// Merges a table of another model into this model. If the model has a table
+// with the same type and number, that table takes the name of the other one
+// if it has one, its mode if it isn't CISCO_MODE_AUTO and all of its
+// interfaces. Otherwise the table is added to the model as it is
+int ciscoModelMergeTable(ciscomodel_t* model, ciscotable_t* table){
+	ciscotable_t* existing = ciscoModelFindTable(model, table->type, table->number);
+
+	if(!existing)
+		return ciscoModelAddTable(model, table);
+
+	if(existing == table)
+		return 0;
+
+	ciscoconst_t retVar = ciscoPortIndexAddTable(model->ports, table, &model->conflict);
+
+	if(retVar)
+		return retVar;
+
+	if(table->name[0])
+		strcpy(existing->name, table->name);
+
+	if(table->mode != CISCO_MODE_AUTO)
+		existing->mode = table->mode;
+
+	existing->dirty = CISCO_DIRTY_ALL;
+	return ciscoAddInterfaces(existing, table->interfaces.items.array, table->interfaces.items.size, model->gc);
+}
+
+// Makes room for interfaceCount more standalone interfaces and tableCount
+// more tables in a model, for callers that know how much they will add
+int ciscoModelReserve(ciscomodel_t* model, size_t interfaceCount, size_t tableCount){
+	if(ciscoVectorReserve(&model->interfaces, model->interfaces.items.size + interfaceCount) || ciscoVectorReserve(&model->tables, model->tables.items.size + tableCount))
+		return CISCO_ERROR_PL32LIB_GC;
+
+	return 0;
+}
+
+// String table used while writing a snapshot. Strings are deduplicated by
+// address, which catches every description interned in the model's pool
+typedef struct ciscosnapstrings {
+	const char** keys;
+	uint32_t* offsets;
+	size_t capacity;
+	uint32_t size;
+} ciscosnapstrings_t;
+
+// Gets the reference of a string in a snapshot, adding it if it's new. Only
+// the reference is computed here, the data is written in a second pass
+static uint32_t ciscoSnapString(ciscosnapstrings_t* strings, const char* string){
+	if(!string)
+		return 0;
+
+	size_t index = ((uintptr_t)string >> 3) & (strings->capacity - 1);
+
+	while(strings->keys[index]){
+		if(strings->keys[index] == string)
+			return strings->offsets[index] + 1;
+
+		index = (index + 1) & (strings->capacity - 1);
+	}
+
+	strings->keys[index] = string;
+	strings->offsets[index] = strings->size;
+	strings->size += strlen(string) + 1;
+
+	return strings->offsets[index] + 1;
+}
+
+// Rounds a snapshot offset up to 8 bytes
+static uint64_t ciscoSnapAlign(uint64_t offset){
+	return (offset + 7) & ~(uint64_t)7;
+}
+
+// Writes zeroes to pad a snapshot section up to an offset
+static ciscoconst_t ciscoSnapPad(ciscosink_t* sink, uint64_t* offset, uint64_t target){
+	static const char zeroes[8] = { 0 };
+	ciscoconst_t retVar = target > *offset ? ciscoSinkWrite(sink, zeroes, target - *offset) : 0;
+
+	*offset = target;
+	return retVar;
+}
+
+// Writes a versioned binary snapshot of a model into a sink. The snapshot
+// can be loaded back with ciscoLoadModel() without parsing any source.
+// Snapshots have no room for port profiles, so models that use them return
+// CISCO_ERROR_INVALID_ACTION
+ciscoconst_t ciscoSaveModel(ciscomodel_t* model, ciscosink_t* sink){
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscosnapheader_t header;
+	ciscosnapstrings_t strings;
+	size_t interfaceCount = model->interfaces.items.size;
+	size_t stringCount = model->tables.items.size + 4;
+	ciscoconst_t retVar = 0;
+
+	if(model->profileRanges.items.size)
+		return CISCO_ERROR_INVALID_ACTION;
+
+	for(int i = 0; i < model->tables.items.size; i++)
+		interfaceCount += tableArr[i]->interfaces.items.size;
+
+	// Standalone interfaces first, then the members of every table in order
+	ciscoint_t** all = ciscoGCAlloc(model->gc, (interfaceCount + 1) * sizeof(ciscoint_t*));
+	size_t allSize = model->interfaces.items.size;
+
+	if(!all)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	memcpy(all, model->interfaces.items.array, allSize * sizeof(ciscoint_t*));
+	for(int i = 0; i < model->tables.items.size; i++){
+		memcpy(all + allSize, tableArr[i]->interfaces.items.array, tableArr[i]->interfaces.items.size * sizeof(ciscoint_t*));
+		allSize += tableArr[i]->interfaces.items.size;
+	}
+
+	stringCount += interfaceCount;
+	strings.capacity = 16;
+	while(strings.capacity < stringCount * 2)
+		strings.capacity *= 2;
+
+	strings.keys = ciscoGCCalloc(model->gc, strings.capacity, sizeof(char*));
+	strings.offsets = ciscoGCAlloc(model->gc, strings.capacity * sizeof(uint32_t));
+	strings.size = 0;
+
+	if(!strings.keys || !strings.offsets){
+		ciscoGCFree(model->gc, all);
+		return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CISCO_SNAPSHOT_MAGIC, 8);
+	header.byteOrder = 0x01020304;
+	header.version = CISCO_SNAPSHOT_VERSION;
+	header.interfaceCount = interfaceCount;
+	header.standaloneCount = model->interfaces.items.size;
+	header.tableCount = model->tables.items.size;
+	header.misc[0] = ciscoSnapString(&strings, model->misc.line_passwd);
+	header.misc[1] = ciscoSnapString(&strings, model->misc.enable_passwd);
+	header.misc[2] = ciscoSnapString(&strings, model->misc.enable_secret);
+	header.misc[3] = ciscoSnapString(&strings, model->misc.hostname);
+
+	for(size_t i = 0; i < interfaceCount; i++){
+		if(all[i]->address)
+			header.addressCount++;
+
+		if(all[i]->allowedVlans)
+			header.vlanSetCount++;
+
+		ciscoSnapString(&strings, all[i]->description);
+	}
+
+	for(int i = 0; i < model->tables.items.size; i++)
+		ciscoSnapString(&strings, tableArr[i]->name);
+
+	header.stringSize = strings.size;
+	header.vlanSetOffset = ciscoSnapAlign(sizeof(header));
+	header.addressOffset = header.vlanSetOffset + (uint64_t)header.vlanSetCount * sizeof(ciscovlanset_t);
+	header.interfaceOffset = ciscoSnapAlign(header.addressOffset + (uint64_t)header.addressCount * sizeof(ciscoaddr_t));
+	header.tableOffset = header.interfaceOffset + (uint64_t)interfaceCount * sizeof(ciscosnapint_t);
+	header.stringOffset = header.tableOffset + (uint64_t)header.tableCount * sizeof(ciscosnaptable_t);
+	header.fileSize = ciscoSnapAlign(header.stringOffset + header.stringSize);
+
+	uint64_t offset = sizeof(header);
+	retVar |= ciscoSinkWrite(sink, (char*)&header, sizeof(header));
+	retVar |= ciscoSnapPad(sink, &offset, header.vlanSetOffset);
+
+	for(size_t i = 0; i < interfaceCount; i++){
+		if(all[i]->allowedVlans)
+			retVar |= ciscoSinkWrite(sink, (char*)all[i]->allowedVlans, sizeof(ciscovlanset_t));
+	}
+
+	for(size_t i = 0; i < interfaceCount; i++){
+		if(all[i]->address)
+			retVar |= ciscoSinkWrite(sink, (char*)all[i]->address, sizeof(ciscoaddr_t));
+	}
+
+	offset = header.addressOffset + (uint64_t)header.addressCount * sizeof(ciscoaddr_t);
+	retVar |= ciscoSnapPad(sink, &offset, header.interfaceOffset);
+
+	uint32_t addressIndex = 0;
+	uint32_t vlanSetIndex = 0;
+
+	for(size_t i = 0; i < interfaceCount; i++){
+		ciscosnapint_t record;
+
+		memset(&record, 0, sizeof(record));
+		record.name = all[i]->name;
+		record.mode = all[i]->mode;
+		record.description = ciscoSnapString(&strings, all[i]->description);
+		record.address = all[i]->address ? ++addressIndex : 0;
+		record.allowedVlans = all[i]->allowedVlans ? ++vlanSetIndex : 0;
+		retVar |= ciscoSinkWrite(sink, (char*)&record, sizeof(record));
+	}
+
+	uint32_t firstMember = model->interfaces.items.size;
+
+	for(int i = 0; i < model->tables.items.size; i++){
+		ciscosnaptable_t record;
+
+		record.type = tableArr[i]->type;
+		record.mode = tableArr[i]->mode;
+		record.number = tableArr[i]->number;
+		record.name = ciscoSnapString(&strings, tableArr[i]->name);
+		record.firstMember = firstMember;
+		record.memberCount = tableArr[i]->interfaces.items.size;
+		firstMember += record.memberCount;
+		retVar |= ciscoSinkWrite(sink, (char*)&record, sizeof(record));
+	}
+
+	// Strings go out in the order their offsets were handed out
+	char* stringData = ciscoGCAlloc(model->gc, strings.size + 1);
+
+	if(stringData){
+		for(size_t i = 0; i < strings.capacity; i++){
+			if(strings.keys[i])
+				strcpy(stringData + strings.offsets[i], strings.keys[i]);
+		}
+
+		retVar |= ciscoSinkWrite(sink, stringData, strings.size);
+		ciscoGCFree(model->gc, stringData);
+	}else{
+		retVar = CISCO_ERROR_PL32LIB_GC;
+	}
+
+	offset = header.stringOffset + header.stringSize;
+	retVar |= ciscoSnapPad(sink, &offset, header.fileSize);
+
+	ciscoGCFree(model->gc, strings.keys);
+	ciscoGCFree(model->gc, strings.offsets);
+	ciscoGCFree(model->gc, all);
+
+	return retVar == CISCO_ERROR_PL32LIB_GC ? retVar : (retVar ? CISCO_ERROR_IO : 0);
+}
+
+// Checks that a snapshot header describes a file of the given size
+static bool ciscoSnapCheckHeader(const ciscosnapheader_t* header, size_t size){
+	if(size < sizeof(ciscosnapheader_t) || memcmp(header->magic, CISCO_SNAPSHOT_MAGIC, 8) != 0)
+		return false;
+
+	if(header->byteOrder != 0x01020304 || header->version != CISCO_SNAPSHOT_VERSION || header->fileSize != size)
+		return false;
+
+	if(header->standaloneCount > header->interfaceCount || header->vlanSetOffset < sizeof(ciscosnapheader_t))
+		return false;
+
+	return header->addressOffset == header->vlanSetOffset + (uint64_t)header->vlanSetCount * sizeof(ciscovlanset_t)
+	       && header->interfaceOffset >= header->addressOffset + (uint64_t)header->addressCount * sizeof(ciscoaddr_t)
+	       && header->tableOffset == header->interfaceOffset + (uint64_t)header->interfaceCount * sizeof(ciscosnapint_t)
+	       && header->stringOffset == header->tableOffset + (uint64_t)header->tableCount * sizeof(ciscosnaptable_t)
+	       && header->stringOffset + header->stringSize <= size
+	       && (header->stringSize == 0 || ((char*)header)[header->stringOffset + header->stringSize - 1] == '\0');
+}
+
+// Builds a model out of a mapped snapshot. VLAN sets, address blocks and
+// strings are used in place, so only the interface and table structures are
+// filled in
+static ciscomodel_t* ciscoSnapBuildModel(char* mapping, plgc_t* gc){
+	ciscosnapheader_t* header = (ciscosnapheader_t*)mapping;
+	ciscovlanset_t* vlanSets = (ciscovlanset_t*)(mapping + header->vlanSetOffset);
+	ciscoaddr_t* addresses = (ciscoaddr_t*)(mapping + header->addressOffset);
+	ciscosnapint_t* intRecords = (ciscosnapint_t*)(mapping + header->interfaceOffset);
+	ciscosnaptable_t* tableRecords = (ciscosnaptable_t*)(mapping + header->tableOffset);
+	char* stringData = mapping + header->stringOffset;
+	char** miscFields[4];
+	ciscoint_t* interfaces = NULL;
+	ciscotable_t* table = NULL;
+	ciscomodel_t* returnModel = ciscoCreateModel(gc);
+
+	if(!returnModel)
+		return NULL;
+
+	miscFields[0] = &returnModel->misc.line_passwd;
+	miscFields[1] = &returnModel->misc.enable_passwd;
+	miscFields[2] = &returnModel->misc.enable_secret;
+	miscFields[3] = &returnModel->misc.hostname;
+
+	for(int i = 0; i < 4; i++){
+		if(header->misc[i] > header->stringSize)
+			goto fail;
+
+		*miscFields[i] = header->misc[i] ? stringData + header->misc[i] - 1 : NULL;
+	}
+
+	// Address blocks are used in place, so they have to be as valid as the
+	// ones ciscoModifyInterface() builds
+	for(uint32_t i = 0; i < header->addressCount; i++){
+		if(addresses[i].flags & ~(CISCO_ADDR_HAS_IP | CISCO_ADDR_HAS_GATEWAY | CISCO_ADDR_IPV6))
+			goto fail;
+
+		if(addresses[i].subMask > ((addresses[i].flags & CISCO_ADDR_IPV6) ? 128 : 32))
+			goto fail;
+	}
+
+	// Every interface lives in one block, the records only need their
+	// references turned into pointers
+	interfaces = ciscoGCAlloc(gc, (header->interfaceCount + 1) * sizeof(ciscoint_t));
+
+	if(!interfaces || ciscoModelReserve(returnModel, header->standaloneCount, header->tableCount))
+		goto fail;
+
+	ciscoint_t** standalone = returnModel->interfaces.items.array;
+
+	for(uint32_t i = 0; i < header->interfaceCount; i++){
+		ciscosnapint_t* record = &intRecords[i];
+		ciscoint_t* interface = &interfaces[i];
+
+		if(record->name.media < CISCO_MEDIA_FASTETH || record->name.media > CISCO_MEDIA_VLAN || record->mode < CISCO_MODE_ACCESS || record->mode > CISCO_MODE_IN_PORTCH)
+			goto fail;
+
+		if(record->name.depth < ciscoMediaTable[record->name.media - CISCO_MEDIA_FASTETH].minDepth || record->name.depth > ciscoMediaTable[record->name.media - CISCO_MEDIA_FASTETH].maxDepth || record->name.port > record->name.lastPort)
+			goto fail;
+
+		if(record->address > header->addressCount || record->allowedVlans > header->vlanSetCount || record->description > header->stringSize)
+			goto fail;
+
+		interface->name = record->name;
+		interface->mode = record->mode;
+		interface->dirty = CISCO_DIRTY_ALL;
+		interface->description = record->description ? stringData + record->description - 1 : NULL;
+		interface->address = record->address ? &addresses[record->address - 1] : NULL;
+		interface->allowedVlans = record->allowedVlans ? &vlanSets[record->allowedVlans - 1] : NULL;
+		interface->snippet.data = NULL;
+		interface->snippet.size = 0;
+		interface->snippet.capacity = 0;
+
+		if(i < header->standaloneCount)
+			standalone[i] = interface;
+	}
+
+	returnModel->interfaces.items.size = header->standaloneCount;
+
+	if(ciscoPortIndexClaim(returnModel->ports, NULL, standalone, header->standaloneCount, NULL))
+		goto fail;
+
+	for(uint32_t i = 0; i < header->tableCount; i++){
+		ciscosnaptable_t* record = &tableRecords[i];
+
+		if(record->firstMember < header->standaloneCount || record->memberCount > header->interfaceCount - record->firstMember || record->name > header->stringSize)
+			goto fail;
+
+		if((record->type != CISCO_INT_VLAN && record->type != CISCO_INT_PORTCH) || record->mode < CISCO_MODE_ACCESS || record->mode > CISCO_MODE_IN_PORTCH)
+			goto fail;
+
+		table = ciscoCreateTable(record->type, record->mode, record->number, gc);
+
+		if(!table || ciscoVectorReserve(&table->interfaces, record->memberCount))
+			goto fail;
+
+		ciscoint_t** members = table->interfaces.items.array;
+
+		if(record->name)
+			strncpy(table->name, stringData + record->name - 1, sizeof(table->name) - 1);
+
+		for(uint32_t j = 0; j < record->memberCount; j++)
+			members[j] = &interfaces[record->firstMember + j];
+
+		table->interfaces.items.size = record->memberCount;
+
+		if(ciscoModelAddTable(returnModel, table))
+			goto fail;
+
+		table = NULL;
+	}
+
+	return returnModel;
+
+	// Nothing of a half-built model is reachable by the caller, so all of it
+	// is freed here. The interfaces are one block and aren't freed one by one
+	fail:
+	if(table){
+		ciscoVectorFree(&table->interfaces);
+		ciscoGCFree(gc, table);
+	}
+
+	for(size_t i = 0; i < returnModel->tables.items.size; i++){
+		ciscotable_t* added = ((ciscotable_t**)returnModel->tables.items.array)[i];
+
+		ciscoVectorFree(&added->interfaces);
+		ciscoGCFree(gc, added);
+	}
+
+	if(interfaces)
+		ciscoGCFree(gc, interfaces);
+
+	ciscoVectorFree(&returnModel->interfaces);
+	ciscoVectorFree(&returnModel->tables);
+	ciscoVectorFree(&returnModel->pools);
+	ciscoVectorFree(&returnModel->profiles);
+	ciscoVectorFree(&returnModel->profileRanges);
+	ciscoVectorFree(&returnModel->sortedRanges);
+
+	if(returnModel->tableSlots)
+		ciscoGCFree(gc, returnModel->tableSlots);
+
+	if(returnModel->ports)
+		ciscoDestroyPortIndex(returnModel->ports);
+
+	if(returnModel->strings){
+		ciscoGCFree(gc, returnModel->strings->slots);
+		ciscoGCFree(gc, returnModel->strings);
+	}
+
+	ciscoGCFree(gc, returnModel);
+	return NULL;
+}
+
+// Loads a model snapshot written by ciscoSaveModel(). The file is mapped
+// copy-on-write and stays mapped for as long as the model is used. Returns
+// NULL if the file can't be read or isn't a valid snapshot for this version
+// and platform
+ciscomodel_t* ciscoLoadModel(const char* path, plgc_t* gc){
+	struct stat fileStat;
+	int fd = open(path, O_RDONLY);
+
+	if(fd < 0)
+		return NULL;
+
+	if(fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(ciscosnapheader_t)){
+		close(fd);
+		return NULL;
+	}
+
+	char* mapping = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(mapping == MAP_FAILED)
+		return NULL;
+
+	ciscomodel_t* returnModel = NULL;
+
+	if(ciscoSnapCheckHeader((ciscosnapheader_t*)mapping, fileStat.st_size))
+		returnModel = ciscoSnapBuildModel(mapping, gc);
+
+	if(!returnModel){
+		munmap(mapping, fileStat.st_size);
+		return NULL;
+	}
+
+	returnModel->mapping = mapping;
+	returnModel->mappingSize = fileStat.st_size;
+
+	return returnModel;
+}
+
+// Gets the standalone interfaces of a model
+plarray_t* ciscoModelGetInterfaces(ciscomodel_t* model){
+	return &model->interfaces.items;
+}
+
+// Gets the tables of a model
+plarray_t* ciscoModelGetTables(ciscomodel_t* model){
+	return &model->tables.items;
+}
+
+// Gets the miscellaneous device settings of a model
+ciscomisc_t* ciscoModelGetMisc(ciscomodel_t* model){
+	return &model->misc;
+}
+
+// Gets the interned string pool shared by everything in a model
+ciscostrpool_t* ciscoModelGetStringPool(ciscomodel_t* model){
+	return model->strings;
+}
+
+// Gets the memory tracker a model allocates from
+plgc_t* ciscoModelGetGC(ciscomodel_t* model){
+	return model->gc;
+}
+
+// Creates an empty subnet check. It allocates from a region of its own, so
+// it can be filled from any thread as long as only one does so at a time
+ciscosubnetcheck_t* ciscoCreateSubnetCheck(void){
+	ciscosubnetcheck_t* returnCheck = calloc(1, sizeof(ciscosubnetcheck_t));
+
+	if(!returnCheck)
+		return NULL;
+
+	returnCheck->region = ciscoCreateRegion(0);
+	if(!returnCheck->region){
+		free(returnCheck);
+		return NULL;
+	}
+
+	ciscoSubnetCheckReset(returnCheck);
+	return returnCheck;
+}
+
+// Copies an interface of a model into a subnet check if it has an address
+static ciscoconst_t ciscoSubnetCheckAddInterface(ciscosubnetcheck_t* check, ciscoint_t* interface, uint32_t device){
+	if(!interface->address || !(interface->address->flags & (CISCO_ADDR_HAS_IP | CISCO_ADDR_HAS_GATEWAY)))
+		return 0;
+
+	ciscosubnetentry_t entry;
+
+	entry.name = interface->name;
+	entry.address = *interface->address;
+	entry.device = device;
+	entry.order = check->entries.items.size;
+	entry.next = 0;
+
+	return ciscoVectorPush(&check->entries, &entry);
+}
+
+// Adds every addressed interface of a model to a subnet check. device tells
+// the models of a fleet apart in the issues
+ciscoconst_t ciscoSubnetCheckAddModel(ciscosubnetcheck_t* check, ciscomodel_t* model, uint32_t device){
+	ciscoregion_t* previous = ciscoUseRegion(check->region);
+	ciscoint_t** interfaceArr = model->interfaces.items.array;
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscoconst_t retVar = 0;
+
+	for(size_t i = 0; i < model->interfaces.items.size && !retVar; i++)
+		retVar = ciscoSubnetCheckAddInterface(check, interfaceArr[i], device);
+
+	for(size_t i = 0; i < model->tables.items.size && !retVar; i++){
+		ciscoint_t** members = tableArr[i]->interfaces.items.array;
+
+		for(size_t j = 0; j < tableArr[i]->interfaces.items.size && !retVar; j++)
+			retVar = ciscoSubnetCheckAddInterface(check, members[j], device);
+	}
+
+	ciscoUseRegion(previous);
+	return retVar;
+}
+
+// Sorts subnet check entries by device, keeping the order they were added in
+static int ciscoCompareSubnetEntries(const void* a, const void* b){
+	const ciscosubnetentry_t* entryA = a;
+	const ciscosubnetentry_t* entryB = b;
+
+	if(entryA->device != entryB->device)
+		return entryA->device < entryB->device ? -1 : 1;
+
+	return entryA->order < entryB->order ? -1 : entryA->order > entryB->order;
+}
+
+// Gets a bit of an address, counting from the most significant one
+static inline uint8_t ciscoAddressBit(const uint8_t* address, size_t bit){
+	return address[bit / 8] >> (7 - bit % 8) & 1;
+}
+
+// Writes an address in text form, followed by its prefix length unless it is
+// negative
+static void ciscoFormatPrefix(char* buffer, const uint8_t* address, bool isIPv6, int prefix){
+	char* end = isIPv6 ? ciscoAppendIPv6(buffer, address) : ciscoAppendIPv4(buffer, address);
+
+	if(prefix >= 0){
+		*end = '/';
+		end = ciscoAppendUint(end + 1, prefix);
+	}
+
+	*end = '\0';
+}
+
+// Records an issue of a subnet check between an entry and an earlier one.
+// other is NULL if the issue has nothing to do with another interface
+static ciscoconst_t ciscoSubnetIssue(ciscosubnetcheck_t* check, ciscoconst_t type, const ciscosubnetentry_t* entry, const ciscosubnetentry_t* other){
+	bool isIPv6 = entry->address.flags & CISCO_ADDR_IPV6;
+	ciscosubnetissue_t issue;
+
+	memset(&issue, 0, sizeof(ciscosubnetissue_t));
+	issue.type = type;
+	issue.device = entry->device;
+	issue.name = entry->name;
+
+	if(type == CISCO_SUBNET_GATEWAY){
+		ciscoFormatPrefix(issue.address, entry->address.gateway, isIPv6, -1);
+	}else{
+		ciscoFormatPrefix(issue.address, entry->address.ipAddr, isIPv6, entry->address.subMask);
+	}
+
+	if(other){
+		issue.hasOther = true;
+		issue.otherDevice = other->device;
+		issue.otherName = other->name;
+		ciscoFormatPrefix(issue.otherAddress, other->address.ipAddr, isIPv6, other->address.subMask);
+	}
+
+	return ciscoVectorPush(&check->issues, &issue);
+}
+
+// Gets the first entry below a trie node, which has to have children
+static ciscosubnetentry_t* ciscoTrieFirstBelow(ciscosubnetcheck_t* check, uint32_t node){
+	ciscotrienode_t* nodeArr = check->nodes.items.array;
+	ciscosubnetentry_t* entryArr = check->entries.items.array;
+
+	do {
+		node = nodeArr[node].child[0] ? nodeArr[node].child[0] : nodeArr[node].child[1];
+	} while(!nodeArr[node].first);
+
+	return &entryArr[nodeArr[node].first - 1];
+}
+
+// Adds the subnet of an entry to the trie and records what it clashes with.
+// Subnets of one device can't overlap at all. Different devices can share a
+// subnet, which is how they reach each other, but not an address, and can't
+// disagree on how long the prefix of a network is
+static ciscoconst_t ciscoSubnetInsert(ciscosubnetcheck_t* check, uint32_t index){
+	ciscosubnetentry_t* entry = ciscoVectorAt(&check->entries, index);
+	uint32_t node = entry->address.flags & CISCO_ADDR_IPV6 ? 1 : 0;
+	ciscosubnetentry_t* clash = NULL;
+	ciscoconst_t type = CISCO_SUBNET_OVERLAP;
+
+	for(size_t bit = 0; bit < entry->address.subMask; bit++){
+		ciscotrienode_t* nodeArr = check->nodes.items.array;
+		uint8_t side = ciscoAddressBit(entry->address.ipAddr, bit);
+
+		// A shorter prefix on the way down contains this one
+		if(!clash && nodeArr[node].first)
+			clash = ciscoVectorAt(&check->entries, nodeArr[node].first - 1);
+
+		if(!nodeArr[node].child[side]){
+			ciscotrienode_t child = { { 0, 0 }, 0, 0 };
+
+			if(ciscoVectorPush(&check->nodes, &child))
+				return CISCO_ERROR_PL32LIB_GC;
+
+			nodeArr = check->nodes.items.array;
+			nodeArr[node].child[side] = check->nodes.items.size - 1;
+		}
+
+		node = nodeArr[node].child[side];
+	}
+
+	ciscotrienode_t* nodeArr = check->nodes.items.array;
+	ciscosubnetentry_t* entryArr = check->entries.items.array;
+
+	// Same prefix: an address used twice is worse than a shared subnet
+	if(!clash){
+		for(uint32_t i = nodeArr[node].first; i; i = entryArr[i - 1].next){
+			ciscosubnetentry_t* other = &entryArr[i - 1];
+
+			if(memcmp(other->address.ipAddr, entry->address.ipAddr, 16) == 0){
+				clash = other;
+				type = CISCO_SUBNET_DUPLICATE;
+				break;
+			}
+
+			if(!clash && other->device == entry->device)
+				clash = other;
+		}
+	}
+
+	// A longer prefix below is contained by this one
+	if(!clash && (nodeArr[node].child[0] || nodeArr[node].child[1]))
+		clash = ciscoTrieFirstBelow(check, node);
+
+	if(nodeArr[node].last){
+		entryArr[nodeArr[node].last - 1].next = index + 1;
+	}else{
+		nodeArr[node].first = index + 1;
+	}
+
+	nodeArr[node].last = index + 1;
+
+	if(clash)
+		return ciscoSubnetIssue(check, type, entry, clash);
+
+	return 0;
+}
+
+// Checks that the gateway of an entry is in its own subnet, or in any subnet
+// of its device if the entry has no address of its own
+static ciscoconst_t ciscoSubnetCheckGateway(ciscosubnetcheck_t* check, ciscosubnetentry_t* entry){
+	bool isIPv6 = entry->address.flags & CISCO_ADDR_IPV6;
+	size_t bits = isIPv6 ? 128 : 32;
+
+	if(entry->address.flags & CISCO_ADDR_HAS_IP){
+		ciscoip_t subnet;
+		ciscoip_t gateway;
+
+		memcpy(subnet.bytes, entry->address.ipAddr, 16);
+		subnet.prefix = entry->address.subMask;
+		subnet.isIPv6 = isIPv6;
+		memcpy(gateway.bytes, entry->address.gateway, 16);
+		gateway.prefix = bits;
+		gateway.isIPv6 = isIPv6;
+
+		if(!ciscoIPContains(&subnet, &gateway))
+			return ciscoSubnetIssue(check, CISCO_SUBNET_GATEWAY, entry, entry);
+
+		return 0;
+	}
+
+	ciscotrienode_t* nodeArr = check->nodes.items.array;
+	ciscosubnetentry_t* entryArr = check->entries.items.array;
+	uint32_t node = isIPv6 ? 1 : 0;
+
+	for(size_t bit = 0; ; bit++){
+		for(uint32_t i = nodeArr[node].first; i; i = entryArr[i - 1].next){
+			if(entryArr[i - 1].device == entry->device)
+				return 0;
+		}
+
+		if(bit == bits || !nodeArr[node].child[ciscoAddressBit(entry->address.gateway, bit)])
+			break;
+
+		node = nodeArr[node].child[ciscoAddressBit(entry->address.gateway, bit)];
+	}
+
+	return ciscoSubnetIssue(check, CISCO_SUBNET_GATEWAY, entry, NULL);
+}
+
+// Checks every address added to a subnet check for duplicate addresses,
+// overlapping subnets and gateways outside of their subnet. Every address is
+// looked up in a binary trie of the subnets, so this takes time proportional
+// to the amount of addresses times their prefix length. issues is set to the
+// issues found, which stay valid until the check is reset, and their amount is
+// returned. Every interface gets at most one address issue
+size_t ciscoSubnetCheckRun(ciscosubnetcheck_t* check, const ciscosubnetissue_t** issues){
+	ciscoregion_t* previous = ciscoUseRegion(check->region);
+	ciscotrienode_t roots[2] = { { { 0, 0 }, 0, 0 }, { { 0, 0 }, 0, 0 } };
+	ciscosubnetentry_t* entryArr = check->entries.items.array;
+	size_t entryCount = check->entries.items.size;
+	ciscoconst_t retVar = 0;
+
+	// Fleets may be added by several threads in any order
+	if(entryCount)
+		qsort(entryArr, entryCount, sizeof(ciscosubnetentry_t), ciscoCompareSubnetEntries);
+
+	check->nodes.items.size = 0;
+	check->issues.items.size = 0;
+	retVar = ciscoVectorAppend(&check->nodes, roots, 2);
+
+	for(size_t i = 0; i < entryCount && !retVar; i++){
+		entryArr[i].order = i;
+		entryArr[i].next = 0;
+
+		if(entryArr[i].address.flags & CISCO_ADDR_HAS_IP)
+			retVar = ciscoSubnetInsert(check, i);
+	}
+
+	for(size_t i = 0; i < entryCount && !retVar; i++){
+		if(entryArr[i].address.flags & CISCO_ADDR_HAS_GATEWAY)
+			retVar = ciscoSubnetCheckGateway(check, &entryArr[i]);
+	}
+
+	ciscoUseRegion(previous);
+	*issues = check->issues.items.array;
+
+	return check->issues.items.size;
+}
+
+// Empties a subnet check, keeping its memory for the next run
+void ciscoSubnetCheckReset(ciscosubnetcheck_t* check){
+	ciscoRegionReset(check->region);
+	ciscoVectorInit(&check->entries, sizeof(ciscosubnetentry_t), 0, NULL);
+	ciscoVectorInit(&check->nodes, sizeof(ciscotrienode_t), 0, NULL);
+	ciscoVectorInit(&check->issues, sizeof(ciscosubnetissue_t), 0, NULL);
+}
+
+// Frees a subnet check and everything it holds
+void ciscoDestroySubnetCheck(ciscosubnetcheck_t* check){
+	ciscoDestroyRegion(check->region);
+	free(check);
+}
+
+// Creates an output sink. CISCO_SINK_BUFFER takes no extra arguments, CISCO_SINK_FD
+// takes a file descriptor and CISCO_SINK_CALLBACK takes a ciscosinkfunc_t and a
+// user data pointer
+ciscosink_t* ciscoCreateSink(ciscoconst_t type, plgc_t* gc, ...){
+	va_list values;
+	va_start(values, gc);
+
+	if(type < CISCO_SINK_BUFFER || type > CISCO_SINK_CALLBACK){
+		va_end(values);
+		return NULL;
+	}
+
+	ciscosink_t* returnSink = ciscoGCAlloc(gc, sizeof(ciscosink_t));
+
+	if(!returnSink){
+		va_end(values);
+		return NULL;
+	}
+
+	returnSink->type = type;
+	returnSink->fd = -1;
+	returnSink->function = NULL;
+	returnSink->userData = NULL;
+	returnSink->buffer = NULL;
+	returnSink->size = 0;
+	returnSink->capacity = 0;
+	returnSink->written = 0;
+	returnSink->compact = false;
+	returnSink->gc = gc;
+
+	switch(type){
+		case CISCO_SINK_FD: ;
+			returnSink->fd = va_arg(values, int);
+			returnSink->capacity = CISCO_SINK_FD_BUFSIZE;
+			break;
+		case CISCO_SINK_CALLBACK: ;
+			returnSink->function = va_arg(values, ciscosinkfunc_t);
+			returnSink->userData = va_arg(values, void*);
+			break;
+		default: ;
+			returnSink->capacity = 256;
+			break;
+	}
+
+	va_end(values);
+
+	if(returnSink->capacity > 0){
+		returnSink->buffer = ciscoGCAlloc(gc, returnSink->capacity);
+
+		if(!returnSink->buffer){
+			ciscoGCFree(gc, returnSink);
+			return NULL;
+		}
+	}
+
+	return returnSink;
+}
+
+// Writes bytes down to the file descriptor of a fd sink
+static ciscoconst_t ciscoSinkWriteFd(ciscosink_t* sink, const char* data, size_t size){
+	ciscoconst_t retVar = 0;
+	size_t offset = 0;
+
+	ciscoStatsBegin(CISCO_PHASE_WRITE);
+
+	while(offset < size){
+		ssize_t written = write(sink->fd, data + offset, size - offset);
+
+		if(written < 0){
+			if(errno == EINTR)
+				continue;
+
+			retVar = CISCO_ERROR_IO;
+			break;
+		}
+
+		offset += written;
+	}
+
+	ciscoStatsEnd(CISCO_PHASE_WRITE, 1, offset);
+	return retVar;
+}
+
+// Writes everything buffered in a fd sink down to its file descriptor
+ciscoconst_t ciscoSinkFlush(ciscosink_t* sink){
+	if(sink->type != CISCO_SINK_FD || sink->size == 0)
+		return 0;
+
+	if(ciscoSinkWriteFd(sink, sink->buffer, sink->size))
+		return CISCO_ERROR_IO;
+
+	sink->size = 0;
+	return 0;
+}
+
+// Grows a buffer sink so that at least size more bytes fit without reallocating
+ciscoconst_t ciscoSinkReserve(ciscosink_t* sink, size_t size){
+	if(sink->type != CISCO_SINK_BUFFER || sink->size + size <= sink->capacity)
+		return 0;
+
+	void* tempPtr = ciscoGCRealloc(sink->gc, sink->buffer, sink->size + size);
+	if(!tempPtr)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	sink->buffer = tempPtr;
+	sink->capacity = sink->size + size;
+	return 0;
+}
+
+// Appends raw bytes to a sink
+ciscoconst_t ciscoSinkWrite(ciscosink_t* sink, const char* data, size_t size){
+	switch(sink->type){
+		case CISCO_SINK_BUFFER: ;
+			if(sink->size + size > sink->capacity){
+				size_t newCapacity = sink->capacity * 2;
+
+				while(newCapacity < sink->size + size)
+					newCapacity *= 2;
+
+				void* tempPtr = ciscoGCRealloc(sink->gc, sink->buffer, newCapacity);
+				if(!tempPtr)
+					return CISCO_ERROR_PL32LIB_GC;
+
+				sink->buffer = tempPtr;
+				sink->capacity = newCapacity;
+			}
+
+			memcpy(sink->buffer + sink->size, data, size);
+			sink->size += size;
+			break;
+		case CISCO_SINK_FD: ;
+			if(sink->size + size > sink->capacity){
+				if(ciscoSinkFlush(sink))
+					return CISCO_ERROR_IO;
+
+				// Writes bigger than the staging buffer go straight through
+				if(size > sink->capacity){
+					if(ciscoSinkWriteFd(sink, data, size))
+						return CISCO_ERROR_IO;
+
+					sink->written += size;
+					return 0;
+				}
+			}
+
+			memcpy(sink->buffer + sink->size, data, size);
+			sink->size += size;
+			break;
+		case CISCO_SINK_CALLBACK: ;
+			if(sink->function(sink->userData, data, size))
+				return CISCO_ERROR_IO;
+			break;
+	}
+
+	sink->written += size;
+	return 0;
+}
+
+// Appends a null-terminated string to a sink
+ciscoconst_t ciscoSinkPuts(ciscosink_t* sink, const char* string){
+	return ciscoSinkWrite(sink, string, strlen(string));
+}
+
+// Gets the contents of a buffer sink. The returned buffer is not null-terminated
+char* ciscoSinkGetBuffer(ciscosink_t* sink, size_t* size){
+	if(sink->type != CISCO_SINK_BUFFER){
+		if(size)
+			*size = 0;
+
+		return NULL;
+	}
+
+	if(size)
+		*size = sink->size;
+
+	return sink->buffer;
+}
+
+// Gets the total amount of bytes written to a sink
+size_t ciscoSinkTell(ciscosink_t* sink){
+	return sink->written;
+}
+
+// Makes the render functions write to a sink using abbreviated keywords and
+// without the exit lines IOS doesn't need. The delta renderer always uses
+// the full keywords
+void ciscoSinkSetCompact(ciscosink_t* sink, bool compact){
+	sink->compact = compact;
+}
+
+// Checks if a sink gets compact output
+bool ciscoSinkIsCompact(ciscosink_t* sink){
+	return sink->compact;
+}
+
+// Empties a buffer sink without releasing its memory
+void ciscoSinkReset(ciscosink_t* sink){
+	if(sink->type == CISCO_SINK_BUFFER)
+		sink->size = 0;
+
+	sink->written = 0;
+}
+
+// Flushes and frees a sink. The file descriptor of a fd sink is left open
+void ciscoDestroySink(ciscosink_t* sink){
+	ciscoSinkFlush(sink);
+
+	if(sink->buffer)
+		ciscoGCFree(sink->gc, sink->buffer);
+
+	ciscoGCFree(sink->gc, sink);
+}
+
+// Appends the "ip address" or "ipv6 address" command of an address block
+static char* ciscoAppendAddress(char* dest, const ciscoaddr_t* address, bool compact){
+	if(!(address->flags & CISCO_ADDR_IPV6)){
+		dest = ciscoAppendString(dest, CISCO_KW(compact, CISCO_KW_IP_ADDR));
+		dest = ciscoAppendIPv4(dest, address->ipAddr);
+		*dest++ = ' ';
+		dest = ciscoAppendMask(dest, address->subMask);
+	}else{
+		dest = ciscoAppendString(dest, CISCO_KW(compact, CISCO_KW_IPV6_ADDR));
+		dest = ciscoAppendIPv6(dest, address->ipAddr);
+		*dest++ = '/';
+		dest = ciscoAppendUint(dest, address->subMask);
+	}
+
+	return dest;
+}
+
+// Gets the keyword of a mode in the form the output wants
+static const char* ciscoRenderModeString(ciscoconst_t mode, bool compact){
+	const char* modeString = ciscoModeToString(mode);
+
+	if(!modeString || !compact)
+		return modeString;
+
+	return ciscoCompactModeTable[mode - CISCO_MODE_ACCESS];
+}
+
+// Appends an interface name the way interface range takes it, with the last
+// port of a range set off by spaces ("f0/1 - 4"). Older IOS releases reject
+// a range without them
+static char* ciscoAppendRangeName(char* dest, const ciscointname_t* name){
+	ciscointname_t first = *name;
+
+	first.lastPort = first.port;
+	dest = ciscoAppendIntName(dest, &first);
+
+	if(name->lastPort != name->port){
+		dest = ciscoAppendString(dest, " - ");
+		dest = ciscoAppendUint(dest, name->lastPort);
+	}
+
+	return dest;
+}
+
+// Renders the settings of an interface for a list of up to
+// CISCO_RANGE_MAXNAMES interface names. tableCmd, if not NULL, is inserted
+// before the closing line
+static ciscoconst_t ciscoRenderInterfaceBody(ciscoint_t* interface, const ciscointname_t* names, size_t nameCount, ciscosink_t* sink, const char* tableCmd, size_t tableCmdSize){
+	char cmdline[CISCO_CMDLINE_MAXSIZE];
+	char* end = cmdline;
+	ciscoaddr_t* address = interface->address;
+	const char* modeString = ciscoRenderModeString(interface->mode, sink->compact);
+	bool isRange = nameCount > 1 || names[0].port != names[0].lastPort;
+
+	end = ciscoAppendString(end, CISCO_KW(sink->compact, isRange ? CISCO_KW_INT_RANGE : CISCO_KW_INT));
+	for(size_t i = 0; i < nameCount; i++){
+		if(i)
+			end = ciscoAppendString(end, " , ");
+
+		end = ciscoAppendRangeName(end, &names[i]);
+	}
+	*end++ = '\n';
+
+	if(modeString){
+		end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_SW_MODE));
+		end = ciscoAppendString(end, modeString);
+		*end++ = '\n';
+	}
+
+	if(address && (address->flags & CISCO_ADDR_HAS_IP)){
+		end = ciscoAppendAddress(end, address, sink->compact);
+		*end++ = '\n';
+	}
+
+	if(interface->description){
+		end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_DESC));
+		end = ciscoAppendString(end, interface->description);
+		*end++ = '\n';
+	}
+
+	if(ciscoSinkWrite(sink, cmdline, end - cmdline))
+		return CISCO_ERROR_IO;
+
+	// The allowed VLAN list can get long, so it's written on its own
+	if(interface->mode == CISCO_MODE_TRUNK && interface->allowedVlans && ciscoVlanSetScan(interface->allowedVlans, 1, true) <= CISCO_VLAN_MAX){
+		char vlanLine[CISCO_VLANSET_MAXSTRING + 32];
+		char* vlanEnd = ciscoAppendString(vlanLine, CISCO_KW(sink->compact, CISCO_KW_ALLOWED));
+
+		vlanEnd = ciscoAppendVlanSet(vlanEnd, interface->allowedVlans);
+		*vlanEnd++ = '\n';
+
+		if(ciscoSinkWrite(sink, vlanLine, vlanEnd - vlanLine))
+			return CISCO_ERROR_IO;
+	}
+
+	end = cmdline;
+	if(tableCmd){
+		memcpy(end, tableCmd, tableCmdSize);
+		end += tableCmdSize;
+	}
+
+	if(address && (address->flags & CISCO_ADDR_HAS_GATEWAY) && !(address->flags & CISCO_ADDR_IPV6)){
+		end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_GATEWAY));
+		end = ciscoAppendIPv4(end, address->gateway);
+		*end++ = '\n';
+	}else{
+		end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_EXIT));
+	}
+
+	return ciscoSinkWrite(sink, cmdline, end - cmdline) ? CISCO_ERROR_IO : 0;
+}
+
+// Renders the IOS commands for an interface into a sink
+ciscoconst_t ciscoRenderInterface(ciscoint_t* interface, ciscosink_t* sink){
+	return ciscoRenderInterfaceBody(interface, &interface->name, 1, sink, NULL, 0);
+}
+
+// Renders the lines a table emits before its interfaces
+static ciscoconst_t ciscoRenderTableHeader(ciscotable_t* table, ciscosink_t* sink){
+	char cmdline[CISCO_CMDLINE_MAXSIZE];
+	char* end = cmdline;
+
+	if(table->type != CISCO_INT_VLAN)
+		return 0;
+
+	end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_VLAN));
+	end = ciscoAppendUint(end, table->number);
+	*end++ = '\n';
+
+	if(table->name[0] != '\0'){
+		end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_NAME));
+		end = ciscoAppendString(end, table->name);
+		*end++ = '\n';
+	}
+
+	end = ciscoAppendString(end, CISCO_KW(sink->compact, CISCO_KW_EXIT));
+	return ciscoSinkWrite(sink, cmdline, end - cmdline) ? CISCO_ERROR_IO : 0;
+}
+
+// Builds the command a table adds to one of its interfaces into buffer and
+// returns its size
+static size_t ciscoBuildTableCmd(ciscotable_t* table, ciscoint_t* interface, bool compact, char* buffer){
+	char* end = buffer;
+
+	switch(table->type){
+		case CISCO_INT_VLAN: ;
+			// VLAN 1 is the default access VLAN of every port
+			if(compact && table->number == 1 && interface->mode != CISCO_MODE_TRUNK)
+				return 0;
+
+			end = ciscoAppendString(end, CISCO_KW(compact, interface->mode == CISCO_MODE_TRUNK ? CISCO_KW_TRUNK_VLAN : CISCO_KW_ACCESS_VLAN));
+			end = ciscoAppendUint(end, table->number);
+			break;
+		case CISCO_INT_PORTCH: ;
+			const char* modeString = ciscoRenderModeString(table->mode, compact);
+
+			end = ciscoAppendString(end, CISCO_KW(compact, CISCO_KW_CHANNEL));
+			end = ciscoAppendUint(end, table->number);
+			end = ciscoAppendString(end, CISCO_KW(compact, CISCO_KW_MODE));
+			end = ciscoAppendString(end, modeString ? modeString : "on");
+			break;
+		default: ;
+			return 0;
+	}
+
+	*end++ = '\n';
+	return end - buffer;
+}
+
+// Renders the IOS commands for a table and all of its interfaces into a sink
+ciscoconst_t ciscoRenderTable(ciscotable_t* table, ciscosink_t* sink){
+	ciscoint_t** array = table->interfaces.items.array;
+	char tableCmd[CISCO_INTNAME_MAXSIZE * 2];
+	ciscoconst_t retVar = ciscoRenderTableHeader(table, sink);
+
+	for(int i = 0; i < table->interfaces.items.size; i++){
+		size_t tableCmdSize = ciscoBuildTableCmd(table, array[i], sink->compact, tableCmd);
+		retVar |= ciscoRenderInterfaceBody(array[i], &array[i]->name, 1, sink, tableCmd, tableCmdSize);
+	}
+
+	return retVar ? CISCO_ERROR_IO : 0;
+}
+
+// Expands "%p" (the port number), "%i" (the interface name) and "%%" in a
+// description template into buffer, which holds CISCO_DESC_MAXSIZE + 1 bytes.
+// Templates without any of them are returned as they are
+static const char* ciscoExpandDescription(const char* template, const ciscointname_t* name, char* buffer){
+	char* end = buffer;
+	char* limit = buffer + CISCO_DESC_MAXSIZE;
+
+	if(!template || !strchr(template, '%'))
+		return template;
+
+	for(const char* pointer = template; *pointer != '\0' && end < limit; pointer++){
+		char insert[CISCO_INTNAME_MAXSIZE];
+
+		if(pointer[0] != '%' || (pointer[1] != 'p' && pointer[1] != 'i' && pointer[1] != '%')){
+			*end++ = *pointer;
+			continue;
+		}
+
+		pointer++;
+		if(*pointer == 'p')
+			*ciscoAppendUint(insert, name->port) = '\0';
+		else if(*pointer == 'i')
+			ciscoFormatIntName(name, insert);
+		else
+			strcpy(insert, "%");
+
+		for(char* copy = insert; *copy != '\0' && end < limit; copy++)
+			*end++ = *copy;
+	}
+
+	*end = '\0';
+	return buffer;
+}
+
+// Builds the settings of one port of a profile range, with its overrides
+// applied, into an interface on the stack. The description template is
+// expanded into descBuffer. Returns the VLAN of the port, or 0 if it has none
+static uint16_t ciscoProfilePort(ciscoprofilerange_t* range, uint16_t port, ciscoint_t* interface, char* descBuffer){
+	ciscoportsettings_t settings = range->profile->settings;
+	ciscoportoverride_t* override = ciscoFindOverride(range, port, NULL);
+
+	if(override){
+		// A port switched to another mode keeps none of the profile's VLAN
+		// settings of the old one: trunks have no access VLAN, and access
+		// ports no allowed list
+		if(override->settings.mode && override->settings.mode != settings.mode){
+			if(override->settings.mode == CISCO_MODE_TRUNK)
+				settings.vlan = 0;
+			else
+				settings.allowedVlans = NULL;
+
+			settings.mode = override->settings.mode;
+		}
+
+		if(override->settings.vlan)
+			settings.vlan = override->settings.vlan;
+
+		if(override->settings.description)
+			settings.description = override->settings.description;
+
+		if(override->settings.allowedVlans)
+			settings.allowedVlans = override->settings.allowedVlans;
+	}
+
+	memset(interface, 0, sizeof(ciscoint_t));
+	interface->name = range->name;
+	interface->name.port = port;
+	interface->name.lastPort = port;
+	interface->mode = settings.mode;
+	interface->description = ciscoExpandDescription(settings.description, &interface->name, descBuffer);
+	interface->allowedVlans = (ciscovlanset_t*)settings.allowedVlans;
+
+	return settings.vlan;
+}
+
+// Renders the ports of a profile range into a sink. Runs of ports without
+// overrides share one "int range" block, unless the description template
+// gives every port its own description
+static ciscoconst_t ciscoRenderProfileRange(ciscoprofilerange_t* range, ciscosink_t* sink){
+	ciscoportoverride_t* overrides = range->overrides.items.array;
+	size_t overrideCount = range->overrides.items.size;
+	const char* template = range->profile->settings.description;
+	bool perPort = template && strchr(template, '%');
+	char descBuffer[CISCO_DESC_MAXSIZE + 1];
+	char vlanCmd[CISCO_INTNAME_MAXSIZE * 2];
+	size_t next = 0;
+
+	for(uint32_t port = range->name.port; port <= range->name.lastPort;){
+		uint32_t last = port;
+		size_t vlanCmdSize = 0;
+		ciscoint_t interface;
+
+		if(next < overrideCount && overrides[next].port == port)
+			next++;
+		else if(!perPort)
+			last = next < overrideCount ? overrides[next].port - 1u : range->name.lastPort;
+
+		uint16_t vlan = ciscoProfilePort(range, port, &interface, descBuffer);
+		interface.name.lastPort = last;
+
+		if(vlan){
+			char* end = ciscoAppendString(vlanCmd, CISCO_KW(sink->compact, interface.mode == CISCO_MODE_TRUNK ? CISCO_KW_TRUNK_VLAN : CISCO_KW_ACCESS_VLAN));
+
+			end = ciscoAppendUint(end, vlan);
+			*end++ = '\n';
+			vlanCmdSize = end - vlanCmd;
+		}
+
+		if(ciscoRenderInterfaceBody(&interface, &interface.name, 1, sink, vlan ? vlanCmd : NULL, vlanCmdSize))
+			return CISCO_ERROR_IO;
+
+		port = last + 1;
+	}
+
+	return 0;
+}
+
+// Renders the ports every applied profile covers into a sink, in the order
+// the profiles were applied
+ciscoconst_t ciscoRenderProfilePorts(ciscomodel_t* model, ciscosink_t* sink){
+	ciscoprofilerange_t** rangeArr = model->profileRanges.items.array;
+
+	for(size_t i = 0; i < model->profileRanges.items.size; i++){
+		if(ciscoRenderProfileRange(rangeArr[i], sink))
+			return CISCO_ERROR_IO;
+	}
+
+	return 0;
+}
+
+// Renders every table, every standalone interface and then every port a
+// profile was applied to of a model into a sink
+ciscoconst_t ciscoRenderModel(ciscomodel_t* model, ciscosink_t* sink){
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscoint_t** interfaceArr = model->interfaces.items.array;
+	ciscoprofilerange_t** rangeArr = model->profileRanges.items.array;
+	size_t start = ciscoSinkTell(sink);
+	ciscoconst_t retVar = 0;
+
+	ciscoStatsBegin(CISCO_PHASE_RENDER_TABLE);
+
+	for(int i = 0; !retVar && i < model->tables.items.size; i++)
+		retVar = ciscoRenderTable(tableArr[i], sink);
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_TABLE, model->tables.items.size, ciscoSinkTell(sink) - start);
+
+	if(retVar)
+		return CISCO_ERROR_IO;
+
+	start = ciscoSinkTell(sink);
+	ciscoStatsBegin(CISCO_PHASE_RENDER_INT);
+
+	for(int i = 0; !retVar && i < model->interfaces.items.size; i++)
+		retVar = ciscoRenderInterface(interfaceArr[i], sink);
+
+	for(size_t i = 0; !retVar && i < model->profileRanges.items.size; i++)
+		retVar = ciscoRenderProfileRange(rangeArr[i], sink);
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_INT, model->interfaces.items.size + model->profileRanges.items.size, ciscoSinkTell(sink) - start);
+
+	return retVar ? CISCO_ERROR_IO : 0;
+}
+
+// Copies the contents of the scratch sink into a snippet cache
+static ciscoconst_t ciscoStoreSnippet(ciscosnippet_t* snippet, ciscosink_t* scratch){
+	size_t size = 0;
+	char* data = ciscoSinkGetBuffer(scratch, &size);
+
+	if(size > snippet->capacity){
+		void* tempPtr = ciscoGCRealloc(scratch->gc, snippet->data, size);
+
+		if(!tempPtr)
+			return CISCO_ERROR_PL32LIB_GC;
+
+		snippet->data = tempPtr;
+		snippet->capacity = size;
+	}
+
+	memcpy(snippet->data, data, size);
+	snippet->size = size;
+	ciscoSinkReset(scratch);
+
+	return 0;
+}
+
+// Splices the cached output of a model into a sink for ciscoRenderModelCached(),
+// re-rendering the objects that changed on the way
+static ciscoconst_t ciscoSpliceModel(ciscomodel_t* model, ciscosink_t* sink, size_t* rerendered){
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscoint_t** interfaceArr = model->interfaces.items.array;
+	char tableCmd[CISCO_INTNAME_MAXSIZE * 2];
+	size_t renderCount = 0;
+	bool renderAll = false;
+
+	if(!model->scratch){
+		model->scratch = ciscoCreateSink(CISCO_SINK_BUFFER, model->gc);
+
+		if(!model->scratch)
+			return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	// The cache only holds one form of the output
+	if(model->scratch->compact != sink->compact){
+		model->scratch->compact = sink->compact;
+		renderAll = true;
+	}
+
+	for(int i = 0; i < model->tables.items.size; i++){
+		ciscotable_t* table = tableArr[i];
+		ciscoint_t** members = table->interfaces.items.array;
+		bool tableDirty = (table->dirty & CISCO_DIRTY_SNIPPET) || renderAll;
+
+		if(tableDirty){
+			ciscoStatsBegin(CISCO_PHASE_RENDER_TABLE);
+			ciscoconst_t retVar = ciscoRenderTableHeader(table, model->scratch) || ciscoStoreSnippet(&table->snippet, model->scratch);
+			ciscoStatsEnd(CISCO_PHASE_RENDER_TABLE, 1, table->snippet.size);
+
+			if(retVar)
+				return CISCO_ERROR_IO;
+
+			table->dirty &= ~CISCO_DIRTY_SNIPPET;
+			renderCount++;
+		}
+
+		if(ciscoSinkWrite(sink, table->snippet.data, table->snippet.size))
+			return CISCO_ERROR_IO;
+
+		// The table's own settings end up in every member's output
+		for(int j = 0; j < table->interfaces.items.size; j++){
+			if(tableDirty || (members[j]->dirty & CISCO_DIRTY_SNIPPET)){
+				ciscoStatsBegin(CISCO_PHASE_RENDER_TABLE);
+				size_t tableCmdSize = ciscoBuildTableCmd(table, members[j], sink->compact, tableCmd);
+				ciscoconst_t retVar = ciscoRenderInterfaceBody(members[j], &members[j]->name, 1, model->scratch, tableCmd, tableCmdSize) || ciscoStoreSnippet(&members[j]->snippet, model->scratch);
+				ciscoStatsEnd(CISCO_PHASE_RENDER_TABLE, 0, members[j]->snippet.size);
+
+				if(retVar)
+					return CISCO_ERROR_IO;
+
+				members[j]->dirty &= ~CISCO_DIRTY_SNIPPET;
+				renderCount++;
+			}
+
+			if(ciscoSinkWrite(sink, members[j]->snippet.data, members[j]->snippet.size))
+				return CISCO_ERROR_IO;
+		}
+	}
+
+	for(int i = 0; i < model->interfaces.items.size; i++){
+		if((interfaceArr[i]->dirty & CISCO_DIRTY_SNIPPET) || renderAll){
+			ciscoStatsBegin(CISCO_PHASE_RENDER_INT);
+			ciscoconst_t retVar = ciscoRenderInterface(interfaceArr[i], model->scratch) || ciscoStoreSnippet(&interfaceArr[i]->snippet, model->scratch);
+			ciscoStatsEnd(CISCO_PHASE_RENDER_INT, 1, interfaceArr[i]->snippet.size);
+
+			if(retVar)
+				return CISCO_ERROR_IO;
+
+			interfaceArr[i]->dirty &= ~CISCO_DIRTY_SNIPPET;
+			renderCount++;
+		}
+
+		if(ciscoSinkWrite(sink, interfaceArr[i]->snippet.data, interfaceArr[i]->snippet.size))
+			return CISCO_ERROR_IO;
+	}
+
+	// Profile ports are never materialized, so there is nothing to cache
+	size_t start = ciscoSinkTell(sink);
+	ciscoconst_t retVar = 0;
+
+	ciscoStatsBegin(CISCO_PHASE_RENDER_INT);
+
+	for(size_t i = 0; !retVar && i < model->profileRanges.items.size; i++){
+		retVar = ciscoRenderProfileRange(((ciscoprofilerange_t**)model->profileRanges.items.array)[i], sink);
+		renderCount++;
+	}
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_INT, model->profileRanges.items.size, ciscoSinkTell(sink) - start);
+
+	if(retVar)
+		return CISCO_ERROR_IO;
+
+	if(rerendered)
+		*rerendered = renderCount;
+
+	return 0;
+}
+
+// Renders a model like ciscoRenderModel(), but keeps the output of every
+// interface and table cached and only re-renders the ones that changed since
+// the last call. The cached parts are spliced into the sink as they are. The
+// amount of objects that had to be re-rendered is stored in rerendered if it
+// isn't NULL
+ciscoconst_t ciscoRenderModelCached(ciscomodel_t* model, ciscosink_t* sink, size_t* rerendered){
+	size_t start = ciscoSinkTell(sink);
+
+	ciscoStatsBegin(CISCO_PHASE_CONCAT);
+	ciscoconst_t retVar = ciscoSpliceModel(model, sink, rerendered);
+	ciscoStatsEnd(CISCO_PHASE_CONCAT, 1, ciscoSinkTell(sink) - start);
+
+	return retVar;
+}
+
+// Sorts port entries by port, keeping the order they were configured in
+static int ciscoComparePortEntries(const void* a, const void* b){
+	const ciscoportentry_t* entryA = a;
+	const ciscoportentry_t* entryB = b;
+
+	if(entryA->key != entryB->key)
+		return entryA->key < entryB->key ? -1 : 1;
+
+	return entryA->order < entryB->order ? -1 : entryA->order > entryB->order;
+}
+
+// Adds one entry per port of an interface (ranges are expanded) to an entry list
+static void ciscoAddPortEntries(ciscoportentry_t* entries, size_t* count, ciscoint_t* interface, ciscotable_t* table){
+	ciscointname_t name = interface->name;
+
+	for(uint32_t port = interface->name.port; port <= interface->name.lastPort; port++){
+		name.port = port;
+		name.lastPort = port;
+
+		entries[*count].key = ciscoPackIntName(&name);
+		entries[*count].order = *count;
+		entries[*count].interface = interface;
+		entries[*count].table = table;
+		entries[*count].range = NULL;
+		entries[*count].pinned = false;
+		(*count)++;
+	}
+}
+
+// Adds one entry per port of a profile range to an entry list
+static void ciscoAddProfileEntries(ciscoportentry_t* entries, size_t* count, ciscoprofilerange_t* range){
+	ciscointname_t name = range->name;
+
+	for(uint32_t port = range->name.port; port <= range->name.lastPort; port++){
+		name.port = port;
+
+		entries[*count].key = ciscoPackIntName(&name);
+		entries[*count].order = *count;
+		entries[*count].interface = NULL;
+		entries[*count].table = NULL;
+		entries[*count].range = range;
+		entries[*count].pinned = false;
+		(*count)++;
+	}
+}
+
+// Lists every port configured in a model, sorted by port. The VLANs and
+// EtherChannels the model defines are stored in vlans, vlanNames and channels
+static ciscoportentry_t* ciscoCollectPorts(ciscomodel_t* model, plgc_t* gc, size_t* count, ciscovlanset_t* vlans, const char** vlanNames, ciscovlanset_t* channels){
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscoint_t** interfaceArr = model->interfaces.items.array;
+	ciscoprofilerange_t** rangeArr = model->profileRanges.items.array;
+	size_t portCount = 0;
+
+	ciscoVlanSetClear(vlans);
+	ciscoVlanSetClear(channels);
+
+	for(int i = 0; i < model->tables.items.size; i++){
+		ciscotable_t* table = tableArr[i];
+		ciscoint_t** members = table->interfaces.items.array;
+
+		if(table->type == CISCO_INT_VLAN && table->number >= 1 && table->number <= CISCO_VLAN_MAX){
+			ciscoVlanSetAdd(vlans, table->number);
+
+			// Later definitions of a VLAN rename it, like they would on the device
+			if(table->name[0] != '\0' || !vlanNames[table->number])
+				vlanNames[table->number] = table->name;
+		}else if(table->type == CISCO_INT_PORTCH && table->number <= CISCO_VLAN_MAX){
+			ciscoVlanSetAdd(channels, table->number);
+		}
+
+		for(int j = 0; j < table->interfaces.items.size; j++)
+			portCount += members[j]->name.lastPort - members[j]->name.port + 1;
+	}
+
+	for(int i = 0; i < model->interfaces.items.size; i++)
+		portCount += interfaceArr[i]->name.lastPort - interfaceArr[i]->name.port + 1;
+
+	for(size_t i = 0; i < model->profileRanges.items.size; i++)
+		portCount += rangeArr[i]->name.lastPort - rangeArr[i]->name.port + 1;
+
+	ciscoportentry_t* entries = ciscoGCAlloc(gc, (portCount + 1) * sizeof(ciscoportentry_t));
+
+	if(!entries)
+		return NULL;
+
+	*count = 0;
+
+	// Same order as ciscoRenderModel(), so later commands override earlier ones
+	for(int i = 0; i < model->tables.items.size; i++){
+		for(int j = 0; j < tableArr[i]->interfaces.items.size; j++)
+			ciscoAddPortEntries(entries, count, ((ciscoint_t**)tableArr[i]->interfaces.items.array)[j], tableArr[i]);
+	}
+
+	for(int i = 0; i < model->interfaces.items.size; i++)
+		ciscoAddPortEntries(entries, count, interfaceArr[i], NULL);
+
+	for(size_t i = 0; i < model->profileRanges.items.size; i++)
+		ciscoAddProfileEntries(entries, count, rangeArr[i]);
+
+	qsort(entries, *count, sizeof(ciscoportentry_t), ciscoComparePortEntries);
+	return entries;
+}
+
+// Folds every entry of the port at entries[index] into the state the port
+// ends up in on the device. Returns the index of the next port
+static size_t ciscoFoldPort(ciscoportentry_t* entries, size_t count, size_t index, ciscoportstate_t* state){
+	uint64_t key = entries[index].key;
+
+	memset(state, 0, sizeof(ciscoportstate_t));
+	state->name = entries[index].interface ? entries[index].interface->name : entries[index].range->name;
+	state->name.port = key & 0xffff;
+	state->name.lastPort = state->name.port;
+
+	for(; index < count && entries[index].key == key; index++){
+		ciscoint_t* interface = entries[index].interface;
+		ciscotable_t* table = entries[index].table;
+		ciscoint_t profilePort;
+
+		// Profile ports are expanded here, and their VLAN acts like a table's
+		if(entries[index].range){
+			uint16_t vlan = ciscoProfilePort(entries[index].range, state->name.port, &profilePort, state->descBuffer);
+
+			interface = &profilePort;
+			if(vlan){
+				state->vlan = vlan;
+				state->trunkVlan = profilePort.mode == CISCO_MODE_TRUNK;
+			}
+		}
+
+		ciscoaddr_t* address = interface->address;
+
+		if(ciscoModeToString(interface->mode))
+			state->mode = interface->mode;
+
+		if(table && table->type == CISCO_INT_VLAN){
+			state->vlan = table->number;
+			state->trunkVlan = interface->mode == CISCO_MODE_TRUNK;
+		}else if(table && table->type == CISCO_INT_PORTCH){
+			state->channel = table->number;
+			state->channelMode = table->mode;
+		}
+
+		if(interface->description)
+			state->description = interface->description;
+
+		if(address && (address->flags & CISCO_ADDR_HAS_IP))
+			state->ipAddr = address;
+
+		if(address && (address->flags & CISCO_ADDR_HAS_GATEWAY) && !(address->flags & CISCO_ADDR_IPV6))
+			state->gateway = address;
+
+		if(interface->mode == CISCO_MODE_TRUNK && interface->allowedVlans && ciscoVlanSetScan(interface->allowedVlans, 1, true) <= CISCO_VLAN_MAX)
+			state->allowedVlans = interface->allowedVlans;
+	}
+
+	return index;
+}
+
+// Checks if two address blocks hold the same address (or the same gateway)
+static bool ciscoSameAddress(const ciscoaddr_t* a, const ciscoaddr_t* b, bool gateway){
+	if(!a || !b)
+		return a == b;
+
+	if((a->flags ^ b->flags) & CISCO_ADDR_IPV6)
+		return false;
+
+	if(gateway)
+		return memcmp(a->gateway, b->gateway, 16) == 0;
+
+	return memcmp(a->ipAddr, b->ipAddr, 16) == 0 && a->subMask == b->subMask;
+}
+
+// Appends the shortest command list that turns the allowed VLANs of a trunk
+// from one set into another. A full list is replaced by "add"/"remove" pairs
+// if those are shorter
+static char* ciscoAppendAllowedDelta(char* dest, const ciscovlanset_t* from, const ciscovlanset_t* to){
+	ciscovlanset_t addSet = *to;
+	ciscovlanset_t removeSet = *from;
+	char* fullEnd = ciscoAppendString(dest, "switchport trunk allowed vlan ");
+	char* deltaEnd;
+
+	fullEnd = ciscoAppendVlanSet(fullEnd, (ciscovlanset_t*)to);
+	*fullEnd++ = '\n';
+
+	for(int i = 0; i < CISCO_VLANSET_WORDS; i++){
+		addSet.bits[i] &= ~from->bits[i];
+		removeSet.bits[i] &= ~to->bits[i];
+	}
+
+	// The pairs are built past the end of the full list, then moved over it
+	deltaEnd = fullEnd;
+	if(ciscoVlanSetScan(&addSet, 1, true) <= CISCO_VLAN_MAX){
+		deltaEnd = ciscoAppendString(deltaEnd, "switchport trunk allowed vlan add ");
+		deltaEnd = ciscoAppendVlanSet(deltaEnd, &addSet);
+		*deltaEnd++ = '\n';
+	}
+
+	if(ciscoVlanSetScan(&removeSet, 1, true) <= CISCO_VLAN_MAX){
+		deltaEnd = ciscoAppendString(deltaEnd, "switchport trunk allowed vlan remove ");
+		deltaEnd = ciscoAppendVlanSet(deltaEnd, &removeSet);
+		*deltaEnd++ = '\n';
+	}
+
+	if(deltaEnd - fullEnd >= fullEnd - dest)
+		return fullEnd;
+
+	memmove(dest, fullEnd, deltaEnd - fullEnd);
+	return dest + (deltaEnd - fullEnd);
+}
+
+// Renders the commands that move a port from one state to another. from is
+// NULL for new ports and to is NULL for removed ones. Nothing is rendered for
+// ports that didn't change
+static ciscoconst_t ciscoRenderPortDelta(const ciscoportstate_t* from, const ciscoportstate_t* to, ciscosink_t* sink){
+	char cmdline[CISCO_CMDLINE_MAXSIZE + CISCO_VLANSET_MAXSTRING * 3];
+	ciscoportstate_t empty;
+	char* end = cmdline;
+
+	// Removed ports are reset as a whole. Logical interfaces are deleted instead
+	if(!to){
+		bool isLogical = from->name.media == CISCO_MEDIA_VLAN || from->name.media == CISCO_MEDIA_PORTCH;
+
+		end = ciscoAppendString(end, isLogical ? "no int " : "default int ");
+		end = ciscoAppendIntName(end, &from->name);
+		*end++ = '\n';
+
+		return ciscoSinkWrite(sink, cmdline, end - cmdline) ? CISCO_ERROR_IO : 0;
+	}
+
+	if(!from){
+		memset(&empty, 0, sizeof(ciscoportstate_t));
+		from = &empty;
+	}
+
+	end = ciscoAppendString(end, "int ");
+	end = ciscoAppendIntName(end, &to->name);
+	*end++ = '\n';
+	char* body = end;
+
+	if(to->mode != from->mode){
+		if(to->mode){
+			end = ciscoAppendString(end, "switchport mode ");
+			end = ciscoAppendString(end, ciscoModeToString(to->mode));
+			*end++ = '\n';
+		}else{
+			end = ciscoAppendString(end, "no switchport mode\n");
+		}
+	}
+
+	if(!ciscoSameAddress(from->ipAddr, to->ipAddr, false)){
+		// An IPv4 address replaces the previous one, IPv6 addresses add up
+		if(from->ipAddr && (!to->ipAddr || (from->ipAddr->flags & CISCO_ADDR_IPV6) || (to->ipAddr->flags & CISCO_ADDR_IPV6))){
+			if(from->ipAddr->flags & CISCO_ADDR_IPV6){
+				end = ciscoAppendString(end, "no ");
+				end = ciscoAppendAddress(end, from->ipAddr, false);
+				*end++ = '\n';
+			}else{
+				end = ciscoAppendString(end, "no ip address\n");
+			}
+		}
+
+		if(to->ipAddr){
+			end = ciscoAppendAddress(end, to->ipAddr, false);
+			*end++ = '\n';
+		}
+	}
+
+	if(from->description != to->description && (!from->description || !to->description || strcmp(from->description, to->description) != 0)){
+		if(to->description){
+			end = ciscoAppendString(end, "description ");
+			end = ciscoAppendString(end, to->description);
+			*end++ = '\n';
+		}else{
+			end = ciscoAppendString(end, "no description\n");
+		}
+	}
+
+	if(!to->allowedVlans){
+		if(from->allowedVlans)
+			end = ciscoAppendString(end, "no switchport trunk allowed vlan\n");
+	}else if(!from->allowedVlans){
+		end = ciscoAppendString(end, "switchport trunk allowed vlan ");
+		end = ciscoAppendVlanSet(end, (ciscovlanset_t*)to->allowedVlans);
+		*end++ = '\n';
+	}else if(memcmp(from->allowedVlans, to->allowedVlans, sizeof(ciscovlanset_t)) != 0){
+		end = ciscoAppendAllowedDelta(end, from->allowedVlans, to->allowedVlans);
+	}
+
+	if(to->vlan != from->vlan || (to->vlan && to->trunkVlan != from->trunkVlan)){
+		if(to->vlan){
+			end = ciscoAppendString(end, to->trunkVlan ? "switchport trunk vlan " : "switchport access vlan ");
+			end = ciscoAppendUint(end, to->vlan);
+			*end++ = '\n';
+		}else{
+			end = ciscoAppendString(end, from->trunkVlan ? "no switchport trunk vlan\n" : "no switchport access vlan\n");
+		}
+	}
+
+	if(to->channel != from->channel || to->channelMode != from->channelMode){
+		if(to->channel){
+			const char* modeString = ciscoModeToString(to->channelMode);
+
+			end = ciscoAppendString(end, "channel-group ");
+			end = ciscoAppendUint(end, to->channel);
+			end = ciscoAppendString(end, " mode ");
+			end = ciscoAppendString(end, modeString ? modeString : "on");
+			*end++ = '\n';
+		}else{
+			end = ciscoAppendString(end, "no channel-group\n");
+		}
+	}
+
+	// The gateway is a global command, so it closes the interface like exit does
+	if(!ciscoSameAddress(from->gateway, to->gateway, true)){
+		if(to->gateway){
+			end = ciscoAppendString(end, "ip default-gateway ");
+			end = ciscoAppendIPv4(end, to->gateway->gateway);
+			*end++ = '\n';
+		}else{
+			end = ciscoAppendString(end, "no ip default-gateway\n");
+		}
+	}else if(end == body){
+		return 0;
+	}else{
+		end = ciscoAppendString(end, "exit\n");
+	}
+
+	return ciscoSinkWrite(sink, cmdline, end - cmdline) ? CISCO_ERROR_IO : 0;
+}
+
+// Compares two models port by port for ciscoRenderModelDelta()
+static ciscoconst_t ciscoDiffModels(ciscomodel_t* from, ciscomodel_t* to, ciscosink_t* sink, size_t* changed){
+	plgc_t* gc = to->gc;
+	const char** fromNames = ciscoGCCalloc(gc, CISCO_VLAN_MAX + 1, sizeof(char*));
+	const char** toNames = ciscoGCCalloc(gc, CISCO_VLAN_MAX + 1, sizeof(char*));
+	ciscovlanset_t fromVlans;
+	ciscovlanset_t toVlans;
+	ciscovlanset_t fromChannels;
+	ciscovlanset_t toChannels;
+	size_t fromCount = 0;
+	size_t toCount = 0;
+	size_t changeCount = 0;
+	ciscoconst_t retVar = 0;
+
+	if(!fromNames || !toNames)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	ciscoportentry_t* fromPorts = ciscoCollectPorts(from, gc, &fromCount, &fromVlans, fromNames, &fromChannels);
+	ciscoportentry_t* toPorts = ciscoCollectPorts(to, gc, &toCount, &toVlans, toNames, &toChannels);
+
+	if(!fromPorts || !toPorts)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	// New and renamed VLANs go first so ports can be moved into them
+	for(uint16_t vlan = ciscoVlanSetScan(&toVlans, 1, true); vlan <= CISCO_VLAN_MAX; vlan = ciscoVlanSetScan(&toVlans, vlan + 1, true)){
+		bool isNew = !ciscoVlanSetTest(&fromVlans, vlan);
+		char cmdline[CISCO_CMDLINE_MAXSIZE];
+		char* end = cmdline;
+
+		if(!isNew && strcmp(fromNames[vlan], toNames[vlan]) == 0)
+			continue;
+
+		end = ciscoAppendString(end, "vlan ");
+		end = ciscoAppendUint(end, vlan);
+		*end++ = '\n';
+
+		if(toNames[vlan][0] != '\0'){
+			end = ciscoAppendString(end, "name ");
+			end = ciscoAppendString(end, toNames[vlan]);
+			*end++ = '\n';
+		}else if(!isNew){
+			end = ciscoAppendString(end, "no name\n");
+		}
+
+		end = ciscoAppendString(end, "exit\n");
+		retVar |= ciscoSinkWrite(sink, cmdline, end - cmdline);
+	}
+
+	size_t fromIndex = 0;
+	size_t toIndex = 0;
+
+	while(!retVar && (fromIndex < fromCount || toIndex < toCount)){
+		ciscoportstate_t fromState;
+		ciscoportstate_t toState;
+		bool hasFrom = fromIndex < fromCount && (toIndex >= toCount || fromPorts[fromIndex].key <= toPorts[toIndex].key);
+		bool hasTo = toIndex < toCount && (fromIndex >= fromCount || toPorts[toIndex].key <= fromPorts[fromIndex].key);
+		size_t written = ciscoSinkTell(sink);
+
+		if(hasFrom)
+			fromIndex = ciscoFoldPort(fromPorts, fromCount, fromIndex, &fromState);
+
+		if(hasTo)
+			toIndex = ciscoFoldPort(toPorts, toCount, toIndex, &toState);
+
+		retVar = ciscoRenderPortDelta(hasFrom ? &fromState : NULL, hasTo ? &toState : NULL, sink);
+
+		if(ciscoSinkTell(sink) != written)
+			changeCount++;
+	}
+
+	// Removals go last, once no port uses them anymore
+	for(uint16_t channel = ciscoVlanSetScan(&fromChannels, 1, true); !retVar && channel <= CISCO_VLAN_MAX; channel = ciscoVlanSetScan(&fromChannels, channel + 1, true)){
+		char cmdline[CISCO_CMDLINE_MAXSIZE];
+		char* end = cmdline;
+
+		if(ciscoVlanSetTest(&toChannels, channel))
+			continue;
+
+		end = ciscoAppendString(end, "no int po");
+		end = ciscoAppendUint(end, channel);
+		*end++ = '\n';
+		retVar |= ciscoSinkWrite(sink, cmdline, end - cmdline);
+	}
+
+	for(uint16_t vlan = ciscoVlanSetScan(&fromVlans, 1, true); !retVar && vlan <= CISCO_VLAN_MAX; vlan = ciscoVlanSetScan(&fromVlans, vlan + 1, true)){
+		char cmdline[CISCO_CMDLINE_MAXSIZE];
+		char* end = cmdline;
+
+		if(ciscoVlanSetTest(&toVlans, vlan))
+			continue;
+
+		end = ciscoAppendString(end, "no vlan ");
+		end = ciscoAppendUint(end, vlan);
+		*end++ = '\n';
+		retVar |= ciscoSinkWrite(sink, cmdline, end - cmdline);
+	}
+
+	ciscoGCFree(gc, fromPorts);
+	ciscoGCFree(gc, toPorts);
+	ciscoGCFree(gc, fromNames);
+	ciscoGCFree(gc, toNames);
+
+	if(changed)
+		*changed = changeCount;
+
+	return retVar ? CISCO_ERROR_IO : 0;
+}
+
+// Renders only the commands needed to move a device configured with one model
+// (from) to the configuration of another one (to), including the "no" forms
+// of anything that has to be removed. Both models are compared port by port
+// after every range is expanded, so the result doesn't depend on how the
+// sources were written. The amount of ports that changed is stored in changed
+// if it isn't NULL
+ciscoconst_t ciscoRenderModelDelta(ciscomodel_t* from, ciscomodel_t* to, ciscosink_t* sink, size_t* changed){
+	size_t start = ciscoSinkTell(sink);
+	size_t changeCount = 0;
+
+	// Every port is compared, so a delta counts as rendering interfaces
+	ciscoStatsBegin(CISCO_PHASE_RENDER_INT);
+	ciscoconst_t retVar = ciscoDiffModels(from, to, sink, &changeCount);
+	ciscoStatsEnd(CISCO_PHASE_RENDER_INT, changeCount, ciscoSinkTell(sink) - start);
+
+	if(changed)
+		*changed = changeCount;
+
+	return retVar;
+}
+
+// Compares every setting of two interfaces except their names
+static int ciscoCompareIntSettings(ciscoint_t* a, ciscoint_t* b){
+	bool hasAddrA = a->address && (a->address->flags & (CISCO_ADDR_HAS_IP | CISCO_ADDR_HAS_GATEWAY));
+	bool hasAddrB = b->address && (b->address->flags & (CISCO_ADDR_HAS_IP | CISCO_ADDR_HAS_GATEWAY));
+	bool hasVlansA = a->mode == CISCO_MODE_TRUNK && a->allowedVlans && ciscoVlanSetScan(a->allowedVlans, 1, true) <= CISCO_VLAN_MAX;
+	bool hasVlansB = b->mode == CISCO_MODE_TRUNK && b->allowedVlans && ciscoVlanSetScan(b->allowedVlans, 1, true) <= CISCO_VLAN_MAX;
+
+	if(a == b)
+		return 0;
+
+	if(a->mode != b->mode)
+		return a->mode < b->mode ? -1 : 1;
+
+	if(hasAddrA != hasAddrB)
+		return hasAddrA ? 1 : -1;
+
+	if(hasAddrA){
+		int retVar = memcmp(a->address, b->address, sizeof(ciscoaddr_t));
+		if(retVar)
+			return retVar;
+	}
+
+	if(a->description != b->description){
+		if(!a->description || !b->description)
+			return a->description ? 1 : -1;
+
+		int retVar = strcmp(a->description, b->description);
+		if(retVar)
+			return retVar;
+	}
+
+	if(hasVlansA != hasVlansB)
+		return hasVlansA ? 1 : -1;
+
+	return hasVlansA ? memcmp(a->allowedVlans, b->allowedVlans, sizeof(ciscovlanset_t)) : 0;
+}
+
+// Sorts pinned entries first in their original order, and the rest by
+// settings and then by name
+static int ciscoCompareCoalesceEntries(const void* a, const void* b){
+	const ciscoportentry_t* entryA = a;
+	const ciscoportentry_t* entryB = b;
+
+	if(entryA->pinned || entryB->pinned){
+		if(entryA->pinned != entryB->pinned)
+			return entryA->pinned ? -1 : 1;
+
+		return entryA->order < entryB->order ? -1 : entryA->order > entryB->order;
+	}
+
+	int retVar = ciscoCompareIntSettings(entryA->interface, entryB->interface);
+	return retVar ? retVar : ciscoComparePortEntries(a, b);
+}
+
+// Renders a list of interfaces, merging the ones with identical settings into
+// "int range" commands of up to CISCO_RANGE_MAXNAMES ranges, the most IOS
+// takes. Interfaces that share a port with another one are rendered on their
+// own and in their original order, since that order decides which settings
+// win on the device
+static ciscoconst_t ciscoRenderCoalesced(ciscoint_t** interfaces, size_t size, ciscotable_t* table, ciscosink_t* sink, plgc_t* gc){
+	ciscoportentry_t* entries = ciscoGCAlloc(gc, (size + 1) * sizeof(ciscoportentry_t));
+	char tableCmd[CISCO_INTNAME_MAXSIZE * 2];
+	size_t tableCmdSize = 0;
+	ciscoconst_t retVar = 0;
+
+	if(!entries)
+		return CISCO_ERROR_PL32LIB_GC;
+
+	for(size_t i = 0; i < size; i++){
+		entries[i].key = ciscoPackIntName(&interfaces[i]->name);
+		entries[i].order = i;
+		entries[i].interface = interfaces[i];
+		entries[i].table = table;
+		entries[i].range = NULL;
+		entries[i].pinned = false;
+	}
+
+	// Sorted by first port, a name overlaps an earlier one if it starts
+	// before the furthest last port seen so far on the same module
+	qsort(entries, size, sizeof(ciscoportentry_t), ciscoComparePortEntries);
+
+	for(size_t i = 1, furthest = 0; i < size; i++){
+		bool sameModule = entries[i].key >> 32 == entries[furthest].key >> 32;
+
+		if(sameModule && entries[i].interface->name.port <= entries[furthest].interface->name.lastPort){
+			entries[i].pinned = true;
+			entries[furthest].pinned = true;
+		}
+
+		if(!sameModule || entries[i].interface->name.lastPort > entries[furthest].interface->name.lastPort)
+			furthest = i;
+	}
+
+	qsort(entries, size, sizeof(ciscoportentry_t), ciscoCompareCoalesceEntries);
+
+	for(size_t i = 0; !retVar && i < size;){
+		ciscoint_t* interface = entries[i].interface;
+		ciscointname_t names[CISCO_RANGE_MAXNAMES];
+		size_t nameCount = 1;
+
+		if(table)
+			tableCmdSize = ciscoBuildTableCmd(table, interface, sink->compact, tableCmd);
+
+		names[0] = interface->name;
+		i++;
+
+		// Entries with the same settings are sorted by name, so neighbouring
+		// ports are merged into one range as they come
+		while(!entries[i - 1].pinned && i < size && !entries[i].pinned && ciscoCompareIntSettings(interface, entries[i].interface) == 0){
+			ciscointname_t* last = &names[nameCount - 1];
+			const ciscointname_t* name = &entries[i].interface->name;
+
+			if(entries[i].key >> 32 == ciscoPackIntName(last) >> 32 && name->port == last->lastPort + 1){
+				last->lastPort = name->lastPort;
+			}else if(nameCount < CISCO_RANGE_MAXNAMES){
+				names[nameCount] = *name;
+				nameCount++;
+			}else{
+				break;
+			}
+
+			i++;
+		}
+
+		retVar = ciscoRenderInterfaceBody(interface, names, nameCount, sink, table ? tableCmd : NULL, tableCmdSize);
+	}
+
+	ciscoGCFree(gc, entries);
+	return retVar;
+}
+
+// Renders a model like ciscoRenderModel(), but merges interfaces with
+// identical settings into "int range" commands. The members of each table
+// and the standalone interfaces are merged separately, and tables are still
+// rendered before the standalone interfaces and profile ports
+ciscoconst_t ciscoRenderModelCoalesced(ciscomodel_t* model, ciscosink_t* sink){
+	ciscotable_t** tableArr = model->tables.items.array;
+	size_t start = ciscoSinkTell(sink);
+	ciscoconst_t retVar = 0;
+
+	ciscoStatsBegin(CISCO_PHASE_RENDER_TABLE);
+
+	for(int i = 0; !retVar && i < model->tables.items.size; i++)
+		retVar = ciscoRenderTableHeader(tableArr[i], sink) || ciscoRenderCoalesced(tableArr[i]->interfaces.items.array, tableArr[i]->interfaces.items.size, tableArr[i], sink, model->gc);
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_TABLE, model->tables.items.size, ciscoSinkTell(sink) - start);
+
+	if(retVar)
+		return CISCO_ERROR_IO;
+
+	start = ciscoSinkTell(sink);
+	ciscoStatsBegin(CISCO_PHASE_RENDER_INT);
+	retVar = ciscoRenderCoalesced(model->interfaces.items.array, model->interfaces.items.size, NULL, sink, model->gc);
+
+	// Profile ranges already are as coalesced as their overrides allow
+	for(size_t i = 0; !retVar && i < model->profileRanges.items.size; i++)
+		retVar = ciscoRenderProfileRange(((ciscoprofilerange_t**)model->profileRanges.items.array)[i], sink);
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_INT, model->interfaces.items.size + model->profileRanges.items.size, ciscoSinkTell(sink) - start);
+
+	return retVar ? CISCO_ERROR_IO : 0;
+}
+
+// Checks if any interface of a coalesced group changed since the group was
+// last cached, and clears their group bits if clear is set
+static bool ciscoGroupDirty(ciscoint_t** interfaces, size_t size, bool clear){
+	bool dirty = false;
+
+	for(size_t i = 0; i < size; i++){
+		dirty |= (interfaces[i]->dirty & CISCO_DIRTY_GROUP) != 0;
+
+		if(clear)
+			interfaces[i]->dirty &= ~CISCO_DIRTY_GROUP;
+	}
+
+	return dirty;
+}
+
+// Renders a model like ciscoRenderModelCoalesced(), but keeps the coalesced
+// output of every table and of the standalone interfaces cached. A group is
+// only coalesced again once one of its interfaces (or its table) changed, it
+// gained or lost members or the form of the output changed. Profile ports
+// are rendered every time. The amount of groups that had to be re-rendered
+// is stored in rerendered if it isn't NULL
+ciscoconst_t ciscoRenderModelCoalescedCached(ciscomodel_t* model, ciscosink_t* sink, size_t* rerendered){
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscoint_t** interfaceArr = model->interfaces.items.array;
+	size_t interfaceCount = model->interfaces.items.size;
+	size_t renderCount = 0;
+	size_t start = ciscoSinkTell(sink);
+	ciscoconst_t retVar = 0;
+
+	if(!model->scratch){
+		model->scratch = ciscoCreateSink(CISCO_SINK_BUFFER, model->gc);
+
+		if(!model->scratch)
+			return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	// The scratch sink's form belongs to ciscoRenderModelCached()
+	bool scratchCompact = model->scratch->compact;
+	model->scratch->compact = sink->compact;
+
+	ciscoStatsBegin(CISCO_PHASE_RENDER_TABLE);
+
+	for(int i = 0; !retVar && i < model->tables.items.size; i++){
+		ciscotable_t* table = tableArr[i];
+		ciscoint_t** members = table->interfaces.items.array;
+		size_t memberCount = table->interfaces.items.size;
+
+		if((table->dirty & CISCO_DIRTY_GROUP) || table->groupMembers != memberCount || table->groupCompact != sink->compact || ciscoGroupDirty(members, memberCount, false)){
+			retVar = ciscoRenderTableHeader(table, model->scratch) || ciscoRenderCoalesced(members, memberCount, table, model->scratch, model->gc) || ciscoStoreSnippet(&table->group, model->scratch);
+
+			if(retVar)
+				break;
+
+			ciscoGroupDirty(members, memberCount, true);
+			table->dirty &= ~CISCO_DIRTY_GROUP;
+			table->groupMembers = memberCount;
+			table->groupCompact = sink->compact;
+			renderCount++;
+		}
+
+		retVar = ciscoSinkWrite(sink, table->group.data, table->group.size);
+	}
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_TABLE, model->tables.items.size, ciscoSinkTell(sink) - start);
+	start = ciscoSinkTell(sink);
+	ciscoStatsBegin(CISCO_PHASE_RENDER_INT);
+
+	if(!retVar && (!model->standaloneCached || model->standaloneCount != interfaceCount || model->standaloneCompact != sink->compact || ciscoGroupDirty(interfaceArr, interfaceCount, false))){
+		retVar = ciscoRenderCoalesced(interfaceArr, interfaceCount, NULL, model->scratch, model->gc) || ciscoStoreSnippet(&model->standalone, model->scratch);
+
+		if(!retVar){
+			ciscoGroupDirty(interfaceArr, interfaceCount, true);
+			model->standaloneCount = interfaceCount;
+			model->standaloneCompact = sink->compact;
+			model->standaloneCached = true;
+			renderCount++;
+		}
+	}
+
+	if(!retVar)
+		retVar = ciscoSinkWrite(sink, model->standalone.data, model->standalone.size);
+
+	// Profile ports are never materialized, so there is nothing to cache
+	for(size_t i = 0; !retVar && i < model->profileRanges.items.size; i++){
+		retVar = ciscoRenderProfileRange(((ciscoprofilerange_t**)model->profileRanges.items.array)[i], sink);
+		renderCount++;
+	}
+
+	ciscoStatsEnd(CISCO_PHASE_RENDER_INT, interfaceCount + model->profileRanges.items.size, ciscoSinkTell(sink) - start);
+
+	// Whatever a failed render left in the scratch sink is of no use
+	if(retVar)
+		ciscoSinkReset(model->scratch);
+
+	model->scratch->compact = scratchCompact;
+
+	if(retVar)
+		return CISCO_ERROR_IO;
+
+	if(rerendered)
+		*rerendered = renderCount;
+
+	return 0;
+}
+
+// Sink callback used by the plfile_t wrappers
+static int ciscoFileSinkWrite(void* userData, const char* data, size_t size){
+	return plFWrite((void*)data, sizeof(char), size, userData) == size ? 0 : 1;
+}
+
+// Renders an interface into a new in-memory plfile_t. Kept for compatibility,
+// new code should use ciscoRenderInterface()
+plfile_t* ciscoParseInterface(ciscoint_t* interface, plgc_t* gc){
+	plfile_t* returnBuffer = plFOpen(NULL, "w+", gc);
+	ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_CALLBACK, gc, ciscoFileSinkWrite, returnBuffer);
+
+	ciscoRenderInterface(interface, sink);
+	ciscoDestroySink(sink);
+
+	return returnBuffer;
+}
+
+// Renders a table into a new in-memory plfile_t. Kept for compatibility, new
+// code should use ciscoRenderTable()
+plfile_t* ciscoParseTable(ciscotable_t* table, plgc_t* gc){
+	plfile_t* returnBuffer = plFOpen(NULL, "w+", gc);
+	ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_CALLBACK, gc, ciscoFileSinkWrite, returnBuffer);
+
+	ciscoRenderTable(table, sink);
+	ciscoDestroySink(sink);
+
+	return returnBuffer;
+}
+
+// Gets the termios speed of a baud rate. Returns false if the rate isn't supported
+static bool ciscoBaudSpeed(uint32_t baudRate, speed_t* speed){
+	switch(baudRate){
+		case 1200: *speed = B1200; break;
+		case 2400: *speed = B2400; break;
+		case 4800: *speed = B4800; break;
+		case 9600: *speed = B9600; break;
+		case 19200: *speed = B19200; break;
+		case 38400: *speed = B38400; break;
+		case 57600: *speed = B57600; break;
+		case 115200: *speed = B115200; break;
+		case 230400: *speed = B230400; break;
+		default: return false;
+	}
+
+	return true;
+}
+
+// Checks whether ciscoConfigureTerminal() can set a line to a baud rate
+bool ciscoIsBaudRate(uint32_t baudRate){
+	speed_t speed;
+
+	return ciscoBaudSpeed(baudRate, &speed);
+}
+
+// Puts a serial line into raw mode with the given speed and flow control. A
+// baud rate of 0 keeps the current speed, which is what pseudo-terminals need
+ciscoconst_t ciscoConfigureTerminal(int fd, uint32_t baudRate, ciscoconst_t flowControl){
+	struct termios attrs;
+	speed_t speed;
+
+	if(tcgetattr(fd, &attrs) != 0)
+		return CISCO_ERROR_IO;
+
+	if(!baudRate){
+		speed = cfgetospeed(&attrs);
+	}else if(!ciscoBaudSpeed(baudRate, &speed)){
+		return CISCO_ERROR_INVALID_VALUE;
+	}
+
+	cfmakeraw(&attrs);
+	cfsetispeed(&attrs, speed);
+	cfsetospeed(&attrs, speed);
+	attrs.c_cflag |= CLOCAL | CREAD;
+	attrs.c_cflag &= ~CRTSCTS;
+	attrs.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+	switch(flowControl){
+		case CISCO_FLOW_NONE: ;
+			break;
+		case CISCO_FLOW_RTSCTS: ;
+			attrs.c_cflag |= CRTSCTS;
+			break;
+		case CISCO_FLOW_XONXOFF: ;
+			attrs.c_iflag |= IXON | IXOFF;
+			break;
+		default: ;
+			return CISCO_ERROR_INVALID_VALUE;
+	}
+
+	// With VMIN 0 an empty read would look like end of file. The push engine
+	// uses non-blocking descriptors, so reads still never block
+	attrs.c_cc[VMIN] = 1;
+	attrs.c_cc[VTIME] = 0;
+
+	if(tcsetattr(fd, TCSANOW, &attrs) != 0)
+		return CISCO_ERROR_IO;
+
+	tcflush(fd, TCIOFLUSH);
+	return 0;
+}
+
+// Allocates a push engine that sends a script to a device over fd. Up to
+// window commands are sent ahead of the device prompt that acknowledges them,
+// and timeout is the amount of milliseconds to wait for a prompt. fd should
+// be non-blocking. The script isn't copied and has to outlive the engine
+ciscopush_t* ciscoCreatePush(int fd, const char* script, size_t size, uint16_t window, int timeout, plgc_t* gc){
+	ciscopush_t* returnPush = ciscoGCAlloc(gc, sizeof(ciscopush_t));
+
+	if(!returnPush)
+		return NULL;
+
+	memset(returnPush, 0, sizeof(ciscopush_t));
+	returnPush->fd = fd;
+	returnPush->script = script;
+	returnPush->window = window ? window : CISCO_PUSH_WINDOW;
+	returnPush->timeout = timeout > 0 ? timeout : CISCO_PUSH_TIMEOUT;
+	returnPush->gc = gc;
+
+	// Only whole lines are sent, a trailing partial line is ignored
+	for(size_t i = 0; i < size; i++){
+		if(script[i] == '\n'){
+			returnPush->totalLines++;
+			returnPush->size = i + 1;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &returnPush->start);
+	returnPush->lastProgress = returnPush->start;
+
+	return returnPush;
+}
+
+// Gets the descriptor a push engine writes to
+int ciscoPushGetFD(ciscopush_t* push){
+	return push->fd;
+}
+
+// Checks if a push engine has anything it can write right now
+bool ciscoPushWantsWrite(ciscopush_t* push){
+	if(!push->synced)
+		return !push->pokeSent;
+
+	return push->writeOffset < push->size && push->linesSent - push->linesAcked < push->window;
+}
+
+// Checks if every line of the script has been acknowledged by the device
+bool ciscoPushDone(ciscopush_t* push){
+	return push->synced && push->linesAcked >= push->totalLines;
+}
+
+// Checks if the current line is a prompt such as "Switch>", "Switch#" or
+// "Switch(config-if)#"
+static bool ciscoPushIsPrompt(ciscopush_t* push){
+	size_t i = 0;
+
+	while(i < push->lineSize && (isalnum((uint8_t)push->lineBuf[i]) || push->lineBuf[i] == '-' || push->lineBuf[i] == '_' || push->lineBuf[i] == '.'))
+		i++;
+
+	if(i == 0)
+		return false;
+
+	if(i < push->lineSize && push->lineBuf[i] == '('){
+		i++;
+		while(i < push->lineSize && (islower((uint8_t)push->lineBuf[i]) || push->lineBuf[i] == '-'))
+			i++;
+
+		if(i >= push->lineSize || push->lineBuf[i] != ')')
+			return false;
+
+		i++;
+	}
+
+	return i == push->lineSize;
+}
+
+// Reads whatever the device sent and counts the prompts in it. Every prompt
+// acknowledges one command, and lines starting with "%" are counted as errors
+// for the command being acknowledged
+ciscoconst_t ciscoPushRead(ciscopush_t* push){
+	char buffer[4096];
+
+	while(true){
+		ssize_t size = read(push->fd, buffer, sizeof(buffer));
+
+		if(size == 0)
+			return CISCO_ERROR_IO;
+
+		if(size < 0){
+			if(errno == EINTR)
+				continue;
+
+			return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : CISCO_ERROR_IO;
+		}
+
+		for(ssize_t i = 0; i < size; i++){
+			char character = buffer[i];
+
+			if(character == '\r' || character == '\n'){
+				push->lineSize = 0;
+				push->skipLine = false;
+				continue;
+			}
+
+			// The echo of a pipelined command follows its prompt on the same line
+			if(push->skipLine)
+				continue;
+
+			if(push->lineSize == 0 && character == '%' && push->synced){
+				push->errors++;
+				if(!push->firstErrorLine)
+					push->firstErrorLine = push->linesAcked + 1;
+			}
+
+			if((character == '#' || character == '>') && ciscoPushIsPrompt(push)){
+				if(!push->synced){
+					push->synced = true;
+				}else if(push->linesAcked < push->linesSent){
+					push->linesAcked++;
+				}
+
+				clock_gettime(CLOCK_MONOTONIC, &push->lastProgress);
+				if(ciscoPushDone(push))
+					push->end = push->lastProgress;
+
+				push->skipLine = true;
+				push->lineSize = 0;
+				continue;
+			}
+
+			if(push->lineSize < CISCO_PUSH_LINEBUF){
+				push->lineBuf[push->lineSize] = character;
+				push->lineSize++;
+			}else{
+				push->skipLine = true;
+			}
+		}
+	}
+}
+
+// Sends lines until the window is full or the device stops taking input. The
+// first call sends an empty line to get a prompt to synchronize on
+ciscoconst_t ciscoPushWrite(ciscopush_t* push){
+	if(!push->synced){
+		if(!push->pokeSent){
+			if(write(push->fd, "\r", 1) == 1){
+				push->pokeSent = true;
+			}else if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR){
+				return CISCO_ERROR_IO;
+			}
+		}
+
+		return 0;
+	}
 
-	uint8_t ipBytes[4] = { 0, 0, 0, 0 };
-	uint8_t ipAdding[4] = { 128, 128, 128, 128 };
+	while(ciscoPushWantsWrite(push)){
+		const char* lineEnd = memchr(push->script + push->writeOffset, '\n', push->size - push->writeOffset);
+		size_t lineSize = lineEnd - push->script - push->writeOffset + 1;
+		ssize_t written = write(push->fd, push->script + push->writeOffset, lineSize);
 
-	for(int i = 0; i < cidrMask; i++){
-		if(i < 8){
-			ipBytes[0] += ipAdding[0];
-			ipAdding[0] = ipAdding[0] >> 1;
-		}else if(i < 16){
-			ipBytes[1] += ipAdding[1];
-			ipAdding[1] = ipAdding[1] >> 1;
-		}else if(i < 24){
-			ipBytes[2] += ipAdding[2];
-			ipAdding[2] = ipAdding[2] >> 1;
-		}else{
-			ipBytes[3] += ipAdding[3];
-			ipAdding[3] = ipAdding[3] >> 1;
+		if(written < 0){
+			if(errno == EINTR)
+				continue;
+
+			return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : CISCO_ERROR_IO;
 		}
-	}
 
-	plarray_t* retArray = plGCAlloc(gc, sizeof(plarray_t));
-	retArray->array = plGCAlloc(gc, 4 * sizeof(uint8_t));
-	retArray->size = 4;
-	memcpy(retArray->array, ipAdding, 4 * sizeof(uint8_t));
+		push->writeOffset += written;
+		if((size_t)written == lineSize)
+			push->linesSent++;
+	}
 
-	return retArray;
+	return 0;
 }
 
-// Converts an interface constant into a string
-char* ciscoGenerateIntString(ciscoconst_t type, plgc_t* gc){
-	char* returnString = plGCCalloc(gc, 5, sizeof(char));
+// Checks if the device has gone quiet for longer than the timeout while
+// commands are waiting for a prompt
+ciscoconst_t ciscoPushCheckTimeout(ciscopush_t* push){
+	struct timespec now;
 
-	switch(type){
-		case CISCO_INT_F0: ;
-			strcpy(returnString, "f0");
-			break;
-		case CISCO_INT_G0: ;
-			strcpy(returnString, "g0");
-			break;
-		case CISCO_INT_G00: ;
-			strcpy(returnString, "g0/0");
-			break;
-		case CISCO_INT_G01: ;
-			strcpy(returnString, "g0/1");
-			break;
-		case CISCO_INT_S00: ;
-			strcpy(returnString, "s0/0");
-			break;
-		case CISCO_INT_S01: ;
-			strcpy(returnString, "s0/1");
-			break;
-		case CISCO_INT_F1: ;
-			strcpy(returnString, "f1");
-			break;
-		case CISCO_INT_G1: ;
-			strcpy(returnString, "g1");
-			break;
-		case CISCO_INT_G11: ;
-			strcpy(returnString, "g1/1");
-			break;
-		default:
-			plGCFree(gc, returnString);
-			returnString = NULL;
-	}
+	if(ciscoPushDone(push) || (push->synced && push->linesSent == push->linesAcked && !ciscoPushWantsWrite(push)))
+		return 0;
 
-	return returnString;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ciscoElapsedMs(&push->lastProgress, &now) > push->timeout ? CISCO_ERROR_TIMEOUT : 0;
 }
 
-// Converts a string into an interface constant
-ciscoconst_t ciscoStringToIntType(char* string){
-	if(strstr(string, "f0/"))
-		return CISCO_INT_F0;
+// Pushes the whole script, blocking until every line has been acknowledged
+ciscoconst_t ciscoPushRun(ciscopush_t* push){
+	struct pollfd pollEntry;
+	ciscoconst_t retVar = 0;
 
-	if(strstr(string, "g0/0/"))
-		return CISCO_INT_G00;
+	pollEntry.fd = push->fd;
+	ciscoStatsBegin(CISCO_PHASE_WRITE);
 
-	if(strstr(string, "g0/1/"))
-		return CISCO_INT_G01;
+	while(!retVar && !ciscoPushDone(push)){
+		pollEntry.events = POLLIN | (ciscoPushWantsWrite(push) ? POLLOUT : 0);
+		pollEntry.revents = 0;
 
-	if(strstr(string, "s0/0/"))
-		return CISCO_INT_S00;
+		int ready = poll(&pollEntry, 1, 100);
 
-	if(strstr(string, "s0/1/"))
-		return CISCO_INT_S01;
+		if(ready < 0 && errno != EINTR){
+			retVar = CISCO_ERROR_IO;
+			break;
+		}
 
-	if(strstr(string, "f1/"))
-		return CISCO_INT_F1;
+		if(ready > 0 && (pollEntry.revents & POLLIN))
+			retVar = ciscoPushRead(push);
 
-	if(strstr(string, "g1/"))
-		return CISCO_INT_G1;
+		if(!retVar && ready > 0 && (pollEntry.revents & (POLLERR | POLLHUP)) && !(pollEntry.revents & POLLIN))
+			retVar = CISCO_ERROR_IO;
 
-	if(strstr(string, "g1/0/"))
-		return CISCO_INT_G10;
+		if(!retVar && ciscoPushWantsWrite(push))
+			retVar = ciscoPushWrite(push);
 
-	if(strstr(string, "g1/1/"))
-		return CISCO_INT_G11;
+		if(!retVar)
+			retVar = ciscoPushCheckTimeout(push);
+	}
 
-	return CISCO_ERROR_INVALID_VALUE;
+	ciscoStatsEnd(CISCO_PHASE_WRITE, push->linesAcked, push->writeOffset);
+	return retVar;
 }
 
-// Converts a mode constant into a string
-char* ciscoGenerateModeString(ciscoconst_t mode, plgc_t* gc){
-	char* returnString = plGCCalloc(gc, 7, sizeof(char));
+// Steps a push engine after its descriptor reported poll() events and checks
+// if it finished. Returns true once it is done or failed, with the result in
+// retVar
+static bool ciscoPushStep(ciscopush_t* push, short events, ciscoconst_t* retVar){
+	*retVar = 0;
 
-	switch(mode){
-		case CISCO_MODE_ACCESS: ;
-			strcpy(returnString, "access");
-			break;
-		case CISCO_MODE_TRUNK: ;
-			strcpy(returnString, "trunk");
-			break;
-		case CISCO_MODE_AUTO: ;
-			strcpy(returnString, "auto");
-			break;
-		case CISCO_MODE_ACTIVE: ;
-			strcpy(returnString, "active");
-			break;
-		case CISCO_MODE_PASSIVE: ;
-			strcpy(returnString, "passive");
-			break;
-		case CISCO_MODE_DESIRABLE: ;
-			strcpy(returnString, "desirable");
-			break;
-		default:
-			plGCFree(gc, returnString);
-			returnString = NULL;
+	if(events & POLLIN){
+		*retVar = ciscoPushRead(push);
+	}else if(events & (POLLERR | POLLHUP)){
+		*retVar = CISCO_ERROR_IO;
 	}
 
-	return returnString;
-}
+	if(!*retVar && ciscoPushWantsWrite(push))
+		*retVar = ciscoPushWrite(push);
 
-// Converts a string into a mode constant
-ciscoconst_t ciscoStringToMode(char* string){
-	if(strcmp(string, "access") == 0)
-		return CISCO_MODE_ACCESS;
+	if(!*retVar)
+		*retVar = ciscoPushCheckTimeout(push);
+
+	return *retVar || ciscoPushDone(push);
+}
 
-	if(strcmp(string, "trunk") == 0)
-		return CISCO_MODE_TRUNK;
+// Fails the engines an event loop gave up on, records the stats of every
+// engine and returns the first error
+static ciscoconst_t ciscoPushFinishAll(ciscopush_t** pushes, size_t count, ciscoconst_t* results, bool* finished){
+	size_t linesAcked = 0;
+	size_t bytesWritten = 0;
 
-	if(strcmp(string, "auto") == 0)
-		return CISCO_MODE_AUTO;
+	for(size_t i = 0; i < count; i++){
+		if(!finished[i])
+			results[i] = CISCO_ERROR_IO;
 
-	if(strcmp(string, "active") == 0)
-		return CISCO_MODE_ACTIVE;
+		linesAcked += pushes[i]->linesAcked;
+		bytesWritten += pushes[i]->writeOffset;
+	}
 
-	if(strcmp(string, "passive") == 0)
-		return CISCO_MODE_PASSIVE;
+	ciscoStatsEnd(CISCO_PHASE_WRITE, linesAcked, bytesWritten);
+	ciscoGCFree(pushes[0]->gc, finished);
 
-	if(strcmp(string, "desirable") == 0)
-		return CISCO_MODE_DESIRABLE;
+	for(size_t i = 0; i < count; i++){
+		if(results[i])
+			return results[i];
+	}
 
-	return CISCO_ERROR_INVALID_VALUE;
+	return 0;
 }
 
-// Allocates memory for an interface structure and returns it
-ciscoint_t* ciscoCreateInterface(ciscoconst_t type, uint8_t port1, uint8_t port2, plgc_t* gc){
-	ciscoint_t* returnInt = plGCAlloc(gc, sizeof(ciscoint_t));
+#ifdef __linux__
 
-	returnInt->type = type;
-	returnInt->mode = CISCO_MODE_ACCESS;
-	returnInt->ports[0] = port1;
-	returnInt->ports[1] = port2;
-	returnInt->allowedVlans = plGCAlloc(gc, sizeof(plarray_t));
-	returnInt->allowedVlans->size = 0;
-	returnInt->allowedVlans->array = plGCAlloc(gc, 2 * sizeof(uint16_t));
-	returnInt->subMask = 24;
-	for(int i = 0; i < 46; i++){
-		returnInt->ipAddr[i] = 0;
-		returnInt->gateway[i] = 0;
-	}
+// Pushes several scripts at once from a single epoll event loop, blocking
+// until every engine is done or failed. Engines only wait for their own
+// device, so a slow one doesn't hold back the others. The result of every
+// engine is stored in results
+ciscoconst_t ciscoPushRunAll(ciscopush_t** pushes, size_t count, ciscoconst_t* results){
+	struct epoll_event events[64];
+	struct epoll_event event;
+	size_t active = 0;
+	int epollFd;
 
-	for(int i = 0; i < 255; i++)
-		returnInt->description[i] = 0;
+	if(count == 0)
+		return 0;
 
-	return returnInt;
-}
+	bool* finished = ciscoGCCalloc(pushes[0]->gc, count, sizeof(bool));
+	epollFd = epoll_create1(0);
 
-// Allocates memory for a table structure and returns it
-ciscotable_t* ciscoCreateTable(ciscoconst_t type, ciscoconst_t mode, uint16_t number, plgc_t* gc){
-	ciscotable_t* returnTable = plGCAlloc(gc, sizeof(ciscotable_t));
+	if(!finished || epollFd < 0){
+		if(finished)
+			ciscoGCFree(pushes[0]->gc, finished);
 
-	returnTable->type = type;
-	returnTable->mode = mode;
-	for(int i = 0; i < 128; i++)
-		returnTable->name[i] = 0;
-	returnTable->number = number;
-	returnTable->interfaces = plGCAlloc(gc, sizeof(plarray_t));
-	returnTable->interfaces->size = 0;
-	returnTable->interfaces->array = plGCAlloc(gc, 2 * sizeof(ciscoint_t*));
+		if(epollFd >= 0)
+			close(epollFd);
 
-	return returnTable;
-}
+		return epollFd < 0 ? CISCO_ERROR_IO : CISCO_ERROR_PL32LIB_GC;
+	}
 
-// Modifies attributes in an interface
-ciscoconst_t ciscoModifyInterface(ciscoint_t* interface, plgc_t* gc, ciscoconst_t modType, ...){
-	va_list values;
-	va_start(values, modType);
-	ciscoconst_t constant;
-	char* string;
-	uint16_t numbers[2];
+	for(size_t i = 0; i < count; i++){
+		results[i] = 0;
+		pushes[i]->pollEvents = EPOLLIN | (ciscoPushWantsWrite(pushes[i]) ? EPOLLOUT : 0);
+		event.events = pushes[i]->pollEvents;
+		event.data.u64 = i;
 
-	// Type parser
-	switch(modType){
-		case CISCO_MODTYPE_TYPE: ;
-		case CISCO_MODTYPE_MODE: ;
-			constant = va_arg(values, int);
-			break;
-		case CISCO_MODTYPE_DESC: ;
-		case CISCO_MODTYPE_IP_ADDR: ;
-		case CISCO_MODTYPE_GATEWAY: ;
-			string = va_arg(values, char*);
-			break;
-		case CISCO_MODTYPE_PORTS: ;
-			numbers[0] = va_arg(values, int);
-		case CISCO_MODTYPE_ALLOW_VLAN: ;
-		case CISCO_MODTYPE_SUBMASK: ;
-			numbers[1] = va_arg(values, int);
-			break;
-		default:
-			return CISCO_ERROR_INVALID_ACTION;
+		if(epoll_ctl(epollFd, EPOLL_CTL_ADD, pushes[i]->fd, &event) != 0){
+			results[i] = CISCO_ERROR_IO;
+			finished[i] = true;
+		}else{
+			active++;
+		}
 	}
 
-	// Action Parser
-	switch(modType){
-		case CISCO_MODTYPE_TYPE: ;
-			if(constant > CISCO_INT_VLAN)
-				return CISCO_ERROR_INVALID_VALUE;
+	ciscoStatsBegin(CISCO_PHASE_WRITE);
 
-			interface->type = constant;
-			break;
-		case CISCO_MODTYPE_MODE: ;
-			if(interface->mode == CISCO_MODE_IN_PORTCH){
-				return CISCO_ERROR_INVALID_ACTION;
-			}else if(constant < CISCO_MODE_ACCESS || constant > CISCO_MODE_IN_PORTCH){
-				return CISCO_ERROR_INVALID_VALUE;
-			}
+	while(active){
+		int ready = epoll_wait(epollFd, events, 64, 100);
 
-			interface->mode = constant;
-			break;
-		case CISCO_MODTYPE_PORTS: ;
-			interface->ports[0] = numbers[0];
-			interface->ports[1] = numbers[1];
+		if(ready < 0 && errno != EINTR)
 			break;
-		case CISCO_MODTYPE_DESC: ;
-			if(strlen(string)+1 > 4096)
-				return CISCO_ERROR_BUFFER_OVERFLOW;
 
-			strcpy(interface->description, string);
-			break;
-		case CISCO_MODTYPE_ALLOW_VLAN: ;
-			if(numbers[1] > 4096)
-				return CISCO_ERROR_OUT_OF_RANGE;
+		for(int i = 0; i < ready; i++){
+			size_t index = events[i].data.u64;
+			short pollEvents = (events[i].events & EPOLLIN ? POLLIN : 0) | (events[i].events & (EPOLLERR | EPOLLHUP) ? POLLERR : 0);
+
+			if(!finished[index] && ciscoPushStep(pushes[index], pollEvents, &results[index])){
+				finished[index] = true;
+				active--;
+				epoll_ctl(epollFd, EPOLL_CTL_DEL, pushes[index]->fd, NULL);
+			}
+		}
 
-			if(interface->allowedVlans->size > 2){
-				void* tempVar = plGCRealloc(gc, interface->allowedVlans->array, (interface->allowedVlans->size + 1) * sizeof(uint16_t));
+		// Engines without events can still time out or need a write after
+		// their window opened up
+		for(size_t i = 0; i < count; i++){
+			if(finished[i])
+				continue;
 
-				if(!tempVar)
-					return CISCO_ERROR_PL32LIB_GC;
+			if(ciscoPushStep(pushes[i], 0, &results[i])){
+				finished[i] = true;
+				active--;
+				epoll_ctl(epollFd, EPOLL_CTL_DEL, pushes[i]->fd, NULL);
+				continue;
+			}
 
-				interface->allowedVlans->array = tempVar;
+			uint32_t wanted = EPOLLIN | (ciscoPushWantsWrite(pushes[i]) ? EPOLLOUT : 0);
+			if(wanted != pushes[i]->pollEvents){
+				pushes[i]->pollEvents = wanted;
+				event.events = wanted;
+				event.data.u64 = i;
+				epoll_ctl(epollFd, EPOLL_CTL_MOD, pushes[i]->fd, &event);
 			}
+		}
+	}
+
+	close(epollFd);
+
+	// Only has engines left to fail if epoll itself failed
+	return ciscoPushFinishAll(pushes, count, results, finished);
+}
+
+#else
+
+// Pushes several scripts at once from a single poll() event loop, blocking
+// until every engine is done or failed. Engines only wait for their own
+// device, so a slow one doesn't hold back the others. The result of every
+// engine is stored in results
+ciscoconst_t ciscoPushRunAll(ciscopush_t** pushes, size_t count, ciscoconst_t* results){
+	size_t active = count;
+
+	if(count == 0)
+		return 0;
+
+	bool* finished = ciscoGCCalloc(pushes[0]->gc, count, sizeof(bool));
+	struct pollfd* pollArr = ciscoGCCalloc(pushes[0]->gc, count, sizeof(struct pollfd));
+	size_t* indexArr = ciscoGCCalloc(pushes[0]->gc, count, sizeof(size_t));
 
-			uint16_t* array = interface->allowedVlans->array;
+	if(!finished || !pollArr || !indexArr){
+		if(finished)
+			ciscoGCFree(pushes[0]->gc, finished);
+		if(pollArr)
+			ciscoGCFree(pushes[0]->gc, pollArr);
+		if(indexArr)
+			ciscoGCFree(pushes[0]->gc, indexArr);
 
-			array[interface->allowedVlans->size] = numbers[1];
-			interface->allowedVlans->size++;
+		return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	for(size_t i = 0; i < count; i++)
+		results[i] = 0;
+
+	ciscoStatsBegin(CISCO_PHASE_WRITE);
+
+	while(active){
+		size_t pollCount = 0;
+
+		// The set is rebuilt every round, as finished engines drop out and
+		// the others only want to write while their window is open
+		for(size_t i = 0; i < count; i++){
+			if(finished[i])
+				continue;
+
+			pollArr[pollCount].fd = pushes[i]->fd;
+			pollArr[pollCount].events = POLLIN | (ciscoPushWantsWrite(pushes[i]) ? POLLOUT : 0);
+			pollArr[pollCount].revents = 0;
+			indexArr[pollCount] = i;
+			pollCount++;
+		}
+
+		int ready = poll(pollArr, pollCount, 100);
+
+		if(ready < 0 && errno != EINTR)
 			break;
-		case CISCO_MODTYPE_IP_ADDR: ;
-		case CISCO_MODTYPE_GATEWAY: ;
-			char* testString;
-			char* writeString;
 
-			if(modType == CISCO_MODTYPE_GATEWAY){
-				testString = interface->ipAddr;
-				writeString = interface->gateway;
-			}else{
-				testString = interface->gateway;
-				writeString = interface->ipAddr;
+		// Engines without events can still time out or need a write after
+		// their window opened up, so all of them are stepped
+		for(size_t i = 0; i < pollCount; i++){
+			size_t index = indexArr[i];
+
+			if(ciscoPushStep(pushes[index], ready > 0 ? pollArr[i].revents : 0, &results[index])){
+				finished[index] = true;
+				active--;
 			}
+		}
+	}
 
-			char* isIPv6[2] = { strchr(string, ':'), strchr(testString, ':') };
-			size_t strSize = strlen(string);
+	ciscoGCFree(pushes[0]->gc, pollArr);
+	ciscoGCFree(pushes[0]->gc, indexArr);
 
-			if(strcmp(testString, "") != 0 && ((isIPv6[0] && !isIPv6[1]) || (isIPv6[1] && !isIPv6[0])))
-				return CISCO_ERROR_MISMATCHED_IPVER;
+	// Only has engines left to fail if poll() itself failed
+	return ciscoPushFinishAll(pushes, count, results, finished);
+}
 
-			if((!isIPv6[0] && strSize > 15) || (isIPv6[0] && strSize > 45))
-				return CISCO_ERROR_BUFFER_OVERFLOW;
+#endif
 
-			memcpy(writeString, string, strSize);
-			break;
-		case CISCO_MODTYPE_SUBMASK: ;
-			if(numbers[1] > 32)
-				return CISCO_ERROR_OUT_OF_RANGE;
+// Gets the progress and throughput of a push engine
+void ciscoPushGetStats(ciscopush_t* push, ciscopushstats_t* stats){
+	struct timespec now;
 
-			interface->subMask = numbers[1];
-			break;
+	if(ciscoPushDone(push)){
+		now = push->end;
+	}else{
+		clock_gettime(CLOCK_MONOTONIC, &now);
 	}
 
-	return 0;
+	stats->linesSent = push->linesSent;
+	stats->linesAcked = push->linesAcked;
+	stats->totalLines = push->totalLines;
+	stats->errors = push->errors;
+	stats->firstErrorLine = push->firstErrorLine;
+	stats->elapsed = ciscoElapsedMs(&push->start, &now) / 1000;
+	stats->linesPerSecond = stats->elapsed > 0 ? push->linesAcked / stats->elapsed : 0;
 }
 
-// Currently not implemented
-ciscoconst_t ciscoModifyTable(ciscotable_t* table, plgc_t* gc, ciscoconst_t modType, ...){
-	return CISCO_ERROR_INVALID_ACTION;
+// Frees a push engine. The descriptor is left open
+void ciscoDestroyPush(ciscopush_t* push){
+	ciscoGCFree(push->gc, push);
 }
 
-// Adds an interface to a table
-int ciscoAddInterface(ciscotable_t* table, ciscoint_t* interface, plgc_t* gc){
-	if(table->interfaces->size > 1){
-		void* tempPtr = plGCRealloc(gc, table->interfaces->array, (table->interfaces->size + 1) * sizeof(ciscoint_t*));
+// Reads a whole file descriptor into a buffer with a spare byte at the end.
+// Used for sources that can't be mapped, like pipes
+static char* ciscoSourceReadAll(int fd, size_t* size, plgc_t* gc){
+	size_t capacity = 65536;
+	char* buffer = ciscoGCAlloc(gc, capacity + 1);
+	ssize_t readSize;
 
-		if(!tempPtr){
-			return CISCO_ERROR_PL32LIB_GC;
-		}
+	*size = 0;
+	while(buffer && (readSize = read(fd, buffer + *size, capacity - *size)) != 0){
+		if(readSize < 0){
+			if(errno == EINTR)
+				continue;
 
-		table->interfaces->array = tempPtr;
-	}
+			ciscoGCFree(gc, buffer);
+			return NULL;
+		}
 
-	ciscoint_t** array = table->interfaces->array;
-	array[table->interfaces->size] = interface;
+		*size += readSize;
+		if(*size == capacity){
+			void* tempPtr = ciscoGCRealloc(gc, buffer, capacity * 2 + 1);
 
-	if(table->type == CISCO_INT_PORTCH)
-		interface->mode = CISCO_MODE_IN_PORTCH;
+			if(!tempPtr){
+				ciscoGCFree(gc, buffer);
+				return NULL;
+			}
 
-	table->interfaces->size++;
+			buffer = tempPtr;
+			capacity *= 2;
+		}
+	}
 
-	return 0;
+	return buffer;
 }
 
-// Gets a pointer to an interface from a table
-ciscoint_t* ciscoGetInterface(ciscotable_t* table, int index){
-	if(index < 0 || index > table->interfaces->size-1){
+// Opens a source file for ciscoSourceNextLine(). Regular files are mapped
+// copy-on-write instead of being read, so only the pages that tokens are
+// terminated in ever get copied. Returns NULL if the file can't be read
+ciscosource_t* ciscoOpenSource(const char* path, plgc_t* gc){
+	struct stat fileStat;
+	int fd = open(path, O_RDONLY);
+
+	if(fd < 0)
 		return NULL;
-	}
 
-	return ((ciscoint_t**)table->interfaces->array)[index];
-}
+	if(fstat(fd, &fileStat) != 0){
+		close(fd);
+		return NULL;
+	}
 
-plfile_t* ciscoParseInterface(ciscoint_t* interface, plgc_t* gc){
-	plfile_t* returnBuffer = plFOpen(NULL, "w+", gc);
-	char* pointerString = ciscoGenerateIntString(interface->type, gc);
-	char cmdline[2048] = "";
+	ciscosource_t* returnSource = ciscoGCCalloc(gc, 1, sizeof(ciscosource_t));
 
-	if(interface->ports[0] == interface->ports[1] || interface->ports[1] == 0){
-		sprintf(cmdline, "int %s/%d\0", pointerString, interface->ports[0]);
-	}else{
-		sprintf(cmdline, "int range %s/%d-%d\0", pointerString, interface->ports[0], interface->ports[1]);
+	if(!returnSource){
+		close(fd);
+		return NULL;
 	}
 
-	plGCFree(gc, pointerString);
-	plFPuts(cmdline, returnBuffer);
+	returnSource->gc = gc;
 
-	pointerString = ciscoGenerateModeString(interface->mode, gc);
-	sprintf(cmdline, "switchport mode %s\n\0", pointerString);
-	plGCFree(gc, pointerString);
-	plFPuts(cmdline, returnBuffer);
+	// Mapped files are only really read once they are tokenized, so most of
+	// the cost of reading them shows up in that phase
+	ciscoStatsBegin(CISCO_PHASE_READ);
 
-	if(strcmp(interface->ipAddr, "") != 0){
-		char* isIpAddrV6 = strchr(interface->ipAddr, ':');
+	// The byte past the end of the file has to be writable to terminate an
+	// unterminated last line. That only holds if the file doesn't end on a
+	// page boundary, so such files are read instead
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	if(S_ISREG(fileStat.st_mode) && fileStat.st_size > 0 && fileStat.st_size % pageSize != 0){
+		void* mapping = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
 
-		if(!isIpAddrV6){
-			plarray_t* octetSubmask = ciscoCidrToOctet(interface->subMask, gc);
-			uint8_t* array = octetSubmask->array;
-			sprintf(cmdline, "ip address %s %d.%d.%d.%d\n\0", interface->ipAddr, array[0], array[1], array[2], array[3]);
-			plShellFreeArray(octetSubmask, false, gc);
-		}else{
-			sprintf(cmdline, "ipv6 address %s/%d\n\0", interface->ipAddr, interface->subMask);
+		if(mapping != MAP_FAILED){
+			madvise(mapping, fileStat.st_size, MADV_SEQUENTIAL);
+			returnSource->data = mapping;
+			returnSource->size = fileStat.st_size;
+			returnSource->mapped = true;
 		}
-
-		plFPuts(cmdline, returnBuffer);
 	}
 
-	if(strcmp(interface->description, "") != 0){
-		sprintf(cmdline, "description %s\n\0", interface->description);
-		plFPuts(cmdline, returnBuffer);
+	if(!returnSource->mapped)
+		returnSource->data = ciscoSourceReadAll(fd, &returnSource->size, gc);
+
+	close(fd);
+	ciscoStatsEnd(CISCO_PHASE_READ, 1, returnSource->size);
+
+	returnSource->tokenCapacity = 16;
+	returnSource->tokens.array = ciscoGCAlloc(gc, returnSource->tokenCapacity * sizeof(char*));
+	returnSource->tokens.size = 0;
+
+	if(!returnSource->data || !returnSource->tokens.array){
+		ciscoCloseSource(returnSource);
+		return NULL;
 	}
 
-	interface->preExitBufmark = plFTell(returnBuffer);
+	return returnSource;
+}
 
-	if(strcmp(interface->gateway, "") != 0){
-		char* isIpAddrV6 = strchr(interface->ipAddr, ':');
+// Creates a reader over the bytes [start, end) of a source that hasn't been
+// read from yet. start and end have to be line boundaries, and slices over
+// ranges that don't overlap can be read from different threads. The data
+// stays owned by the source, which has to outlive its slices
+ciscosource_t* ciscoSourceSlice(ciscosource_t* source, size_t start, size_t end, plgc_t* gc){
+	if(start > end || end > source->size)
+		return NULL;
 
-		if(!isIpAddrV6)
-			sprintf(cmdline, "ip default-gateway %s\n\0", interface->gateway);
+	ciscosource_t* returnSource = ciscoGCCalloc(gc, 1, sizeof(ciscosource_t));
 
-		plFPuts(cmdline, returnBuffer);
-	}else{
-		plFPuts("exit\n", returnBuffer);
+	if(!returnSource)
+		return NULL;
+
+	returnSource->data = source->data + start;
+	returnSource->size = end - start;
+	returnSource->borrowed = true;
+	returnSource->tokenCapacity = 16;
+	returnSource->tokens.array = ciscoGCAlloc(gc, returnSource->tokenCapacity * sizeof(char*));
+	returnSource->gc = gc;
+
+	if(!returnSource->tokens.array){
+		ciscoGCFree(gc, returnSource);
+		return NULL;
 	}
 
-	return returnBuffer;
+	return returnSource;
 }
 
-plfile_t* ciscoParseTable(ciscotable_t* table, plgc_t* gc){
-	plfile_t* returnBuffer = plFOpen(NULL, "w+", gc);
-	ciscoint_t** array = table->interfaces->array;
-	char placeholder[9] = "";
-	char cmdline[192] = "";
+// Tokenizes the next line of a source. Tokens are split on whitespace, and a
+// token starting with a double quote runs up to the closing quote. The
+// returned array and the tokens in it point into the source and are only
+// valid until the next call. Returns NULL once every line has been read
+plarray_t* ciscoSourceNextLine(ciscosource_t* source){
+	if(source->offset >= source->size)
+		return NULL;
 
-	switch(table->type){
-		case CISCO_INT_VLAN: ;
-			sprintf(cmdline, "vlan %d\n\0", table->number);
-			plFPuts(cmdline, returnBuffer);
+	ciscoStatsBegin(CISCO_PHASE_TOKENIZE);
 
-			if(strcmp(table->name, "") != 0){
-				sprintf(cmdline, "name %s\n\0", table->name);
-				plFPuts(cmdline, returnBuffer);
-			}
-			plFPuts("exit\n", returnBuffer);
-
-			for(int i = 0; i < table->interfaces->size; i++){
-				plfile_t* tempFile = ciscoParseInterface(array[i], gc);
-
-				switch(array[i]->mode){
-					case CISCO_MODE_TRUNK: ;
-						strcpy(placeholder, "trunk");
-						break;
-					default: ;
-						strcpy(placeholder, "access");
-						break;
-				}
-				sprintf(cmdline, "switchport %s vlan %d\n\0", placeholder, table->number);
+	char* line = source->data + source->offset;
+	char* lineEnd = memchr(line, '\n', source->size - source->offset);
 
-				plFSeek(tempFile, plFTell(tempFile), SEEK_SET);
-				plFPuts(cmdline, tempFile);
-				plFCat(returnBuffer, tempFile, SEEK_END, SEEK_SET, true);
-			}
-			break;
-		case CISCO_INT_PORTCH: ;
-			char* tempString = ciscoGenerateModeString(table->mode, gc);
-			sprintf(cmdline, "channel-group %d mode %s\n\0", table->number, tempString);
-			plGCFree(gc, tempString);
+	if(!lineEnd)
+		lineEnd = source->data + source->size;
 
-			for(int i = 0; i < table->interfaces->size; i++){
-				plfile_t* tempFile = ciscoParseInterface(array[i], gc);
+	source->offset = lineEnd - source->data + 1;
+	source->lineNum++;
+	source->tokens.size = 0;
 
-				plFSeek(tempFile, plFTell(tempFile), SEEK_SET);
-				plFPuts(cmdline, tempFile);
-				plFCat(returnBuffer, tempFile, SEEK_END, SEEK_SET, true);
-			}
+	char* pointer = line;
+	while(pointer < lineEnd){
+		while(pointer < lineEnd && isspace((unsigned char)*pointer))
+			pointer++;
+
+		if(pointer == lineEnd)
 			break;
+
+		char* token = pointer;
+		if(*pointer == '"'){
+			token = ++pointer;
+			while(pointer < lineEnd && *pointer != '"')
+				pointer++;
+		}else{
+			while(pointer < lineEnd && !isspace((unsigned char)*pointer))
+				pointer++;
+		}
+
+		if(source->tokens.size + 1 >= source->tokenCapacity){
+			void* tempPtr = ciscoGCRealloc(source->gc, source->tokens.array, source->tokenCapacity * 2 * sizeof(char*));
+
+			if(!tempPtr)
+				break;
+
+			source->tokens.array = tempPtr;
+			source->tokenCapacity *= 2;
+		}
+
+		((char**)source->tokens.array)[source->tokens.size] = token;
+		source->tokens.size++;
+
+		// Terminating the token overwrites the whitespace, closing quote or
+		// newline after it, none of which are needed anymore
+		bool atEnd = pointer == lineEnd;
+		*pointer = '\0';
+		if(!atEnd)
+			pointer++;
 	}
 
-	return returnBuffer;
+	((char**)source->tokens.array)[source->tokens.size] = NULL;
+	ciscoStatsEnd(CISCO_PHASE_TOKENIZE, 1, lineEnd - line);
+	return &source->tokens;
+}
+
+// Gets the number of the line last returned by ciscoSourceNextLine()
+size_t ciscoSourceGetLine(ciscosource_t* source){
+	return source->lineNum;
+}
+
+// Gets the size of a source in bytes
+size_t ciscoSourceGetSize(ciscosource_t* source){
+	return source->size;
+}
+
+// Gets the raw text of a source. Lines that have already been read have
+// their tokens terminated in place
+const char* ciscoSourceGetData(ciscosource_t* source){
+	return source->data;
+}
+
+void ciscoCloseSource(ciscosource_t* source){
+	// Slices don't own their data
+	if(!source->borrowed){
+		if(source->mapped){
+			munmap(source->data, source->size);
+		}else if(source->data){
+			ciscoGCFree(source->gc, source->data);
+		}
+	}
+
+	if(source->tokens.array)
+		ciscoGCFree(source->gc, source->tokens.array);
+
+	ciscoGCFree(source->gc, source);
 }
 
 void ciscoPrintInterface(ciscoint_t* interface, plgc_t* gc){
-	char* pointerString = ciscoGenerateIntString(interface->type, gc);
+	char nameString[CISCO_INTNAME_MAXSIZE];
 
-	if(interface->ports[0] == interface->ports[1]){
-		printf("Interface %s/%d\n\n", pointerString, interface->ports[0]);
+	ciscoFormatIntName(&interface->name, nameString);
+	if(interface->name.port == interface->name.lastPort){
+		printf("Interface %s\n\n", nameString);
 	}else{
-		printf("Interface range %s/%d-%d\n\n", pointerString, interface->ports[0], interface->ports[1]);
+		printf("Interface range %s\n\n", nameString);
 	}
 
-	plGCFree(gc, pointerString);
-	pointerString = ciscoGenerateModeString(interface->mode, gc);
+	char* pointerString = ciscoGenerateModeString(interface->mode, gc);
 
 	printf("	Mode: %s\n", pointerString);
-	plGCFree(gc, pointerString);
+	ciscoGCFree(gc, pointerString);
 
-	if(strcmp(interface->ipAddr, "") != 0){
-		printf("	IP Address: %s\n", interface->ipAddr);
-		printf("	Subnet Mask (CIDR): %d\n", interface->subMask);
-		if(strcmp(interface->gateway, "") != 0)
-			printf("	Default Gateway: %s\n", interface->gateway);
+	ciscoaddr_t* address = interface->address;
+	char addrString[INET6_ADDRSTRLEN];
+	int family = address && (address->flags & CISCO_ADDR_IPV6) ? AF_INET6 : AF_INET;
+
+	if(address && (address->flags & CISCO_ADDR_HAS_IP)){
+		printf("	IP Address: %s\n", inet_ntop(family, address->ipAddr, addrString, sizeof(addrString)));
+		printf("	Subnet Mask (CIDR): %d\n", address->subMask);
+		if(address->flags & CISCO_ADDR_HAS_GATEWAY)
+			printf("	Default Gateway: %s\n", inet_ntop(family, address->gateway, addrString, sizeof(addrString)));
 	}
 
-	if(strcmp(interface->description, "") != 0)
+	if(interface->description)
 		printf("	Description: %s\n", interface->description);
+
+	if(interface->allowedVlans)
+		printf("	Allowed VLANs: %zu\n", ciscoVlanSetCount(interface->allowedVlans));
 }
 
 void ciscoPrintTable(ciscotable_t* table, plgc_t* gc){
@@ -515,9 +6026,46 @@ void ciscoPrintTable(ciscotable_t* table, plgc_t* gc){
 
 			printf("EtherChannel %d\n\n", table->number);
 			printf("	Mode: %s\n", tempString);
-			plGCFree(gc, tempString);
+			ciscoGCFree(gc, tempString);
 			break;
 	}
 
-	printf("	Number of Interfaces: %d\n", table->interfaces->size);
+	printf("	Number of Interfaces: %zu\n", table->interfaces.items.size);
+}
+
+static void ciscoPrintProfileRange(ciscoprofilerange_t* range, plgc_t* gc){
+	char nameString[CISCO_INTNAME_MAXSIZE];
+
+	ciscoFormatIntName(&range->name, nameString);
+	printf("Profile %s on %s\n\n", range->profile->name, nameString);
+
+	char* pointerString = ciscoGenerateModeString(range->profile->settings.mode, gc);
+
+	if(pointerString){
+		printf("	Mode: %s\n", pointerString);
+		ciscoGCFree(gc, pointerString);
+	}
+
+	if(range->profile->settings.vlan)
+		printf("	VLAN: %u\n", range->profile->settings.vlan);
+
+	if(range->profile->settings.description)
+		printf("	Description: %s\n", range->profile->settings.description);
+
+	printf("	Overridden Ports: %zu\n", range->overrides.items.size);
+}
+
+void ciscoPrintModel(ciscomodel_t* model){
+	ciscoint_t** interfaceArr = model->interfaces.items.array;
+	ciscotable_t** tableArr = model->tables.items.array;
+	ciscoprofilerange_t** rangeArr = model->profileRanges.items.array;
+
+	for(int i = 0; i < model->interfaces.items.size; i++)
+		ciscoPrintInterface(interfaceArr[i], model->gc);
+
+	for(int i = 0; i < model->tables.items.size; i++)
+		ciscoPrintTable(tableArr[i], model->gc);
+
+	for(size_t i = 0; i < model->profileRanges.items.size; i++)
+		ciscoPrintProfileRange(rangeArr[i], model->gc);
 }
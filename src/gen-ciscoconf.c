@@ -5,224 +5,1874 @@
 \************************************/
 #include <ciscolib-const.h>
 #include <ciscolib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <ctype.h>
+
+// Batch job structure
+typedef struct batchjob {
+	char* sourcePath;
+	char* outputPath;
+	double elapsed;
+	size_t outputSize;
+	size_t failedLine;
+	size_t peakBytes;
+	int status;
+	char* sameOutput;
+} batchjob_t;
+
+// Batch work queue structure
+typedef struct batchqueue {
+	batchjob_t* jobs;
+	size_t size;
+	size_t next;
+	plarray_t* commandBuf;
+	size_t reservedBytes;
+	ciscosubnetcheck_t* subnets;
+	pthread_mutex_t lock;
+} batchqueue_t;
+
+// Device push job structure
+typedef struct pushjob {
+	char* sourcePath;
+	char* devicePath;
+	int fd;
+	ciscopush_t* push;
+	long failedLine;
+	ciscoconst_t status;
+} pushjob_t;
+
+// Source line of a parse chunk that isn't a parser command, along with the
+// size of the chunk's partial model when it was reached
+typedef struct deferredcmd {
+	plarray_t args;
+	long lineNum;
+	size_t intCount;
+	size_t tableCount;
+} deferredcmd_t;
+
+// Memory a parse chunk allocates from. It has to outlive the partial model
+typedef struct chunkmemory {
+	plgc_t* gc;
+	ciscoregion_t* region;
+} chunkmemory_t;
+
+// Parse chunk structure. Every chunk is parsed by its own thread into a
+// partial model allocated from its own region and memory tracker
+typedef struct parsechunk {
+	ciscosource_t* source;
+	size_t start;
+	size_t end;
+	ciscosource_t* slice;
+	plarray_t* commandBuf;
+	ciscomodel_t* model;
+	ciscovector_t deferred;
+	long lineCount;
+	long failedLine;
+	plgc_t* gc;
+	ciscoregion_t* region;
+	bool threaded;
+} parsechunk_t;
 
 bool verbose = false;
 bool parseOnly = false;
 bool snippet = false;
 bool router = false;
 bool isTerminal = false;
-plarray_t* interfaces;
-plarray_t* tables;
-plfile_t* generatedConfig;
+bool compact = false;
+bool coalesce = true;
+__thread ciscomodel_t* model;
+__thread ciscosubnetcheck_t* subnetCheck = NULL;
+ciscomodel_t* baseModel = NULL;
+bool parsingBase = false;
+bool nonInteractive = false;
+ciscosink_t* generatedConfig;
 char* outputPath = NULL;
+uint32_t baudRate = 9600;
+ciscoconst_t flowControl = CISCO_FLOW_NONE;
+long pushWindow = CISCO_PUSH_WINDOW;
+long parseThreads = 1;
+ciscostats_t* runStats = NULL;
+bool statsJson = false;
+
+int showConfig(plarray_t* args, plgc_t* gc){
+	if(parsingBase || nonInteractive)
+		return 0;
+
+	char** argv = args ? args->array : NULL;
+	if(args && args->size > 1 && strcmp(argv[1], "gen-conf") == 0){
+		size_t size = 0;
+		char* text = ciscoSinkGetBuffer(generatedConfig, &size);
+		fwrite(text, sizeof(char), size, stdout);
+	}else{
+		ciscoPrintModel(model);
+	}
+
+	return 0;
+}
+
+// Writes the current model to a binary snapshot file. The snapshot is
+// written next to the file and only replaces it once it is complete, so a
+// failed save leaves an older snapshot as it was
+int saveModel(char* savePath, plgc_t* gc){
+	char* tempPath = plGCAlloc(gc, strlen(savePath) + 5);
+	sprintf(tempPath, "%s.tmp", savePath);
+
+	int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if(fd < 0){
+		printf("%s: Unable to open file\n", savePath);
+		plGCFree(gc, tempPath);
+		return 1;
+	}
+
+	ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_FD, gc, fd);
+	ciscoconst_t retVar = ciscoSaveModel(model, sink);
+
+	if(!retVar)
+		retVar = ciscoSinkFlush(sink);
+
+	ciscoDestroySink(sink);
+	if(close(fd) != 0 && !retVar)
+		retVar = CISCO_ERROR_IO;
+
+	if(!retVar && rename(tempPath, savePath) != 0)
+		retVar = CISCO_ERROR_IO;
+
+	if(retVar)
+		unlink(tempPath);
+
+	plGCFree(gc, tempPath);
+
+	if(retVar == CISCO_ERROR_INVALID_ACTION){
+		printf("%s: Models with port profiles can't be saved\n", savePath);
+		return 1;
+	}else if(retVar){
+		printf("%s: Unable to save model\n", savePath);
+		return 1;
+	}
+
+	return 0;
+}
+
+// Opens a terminal device for pushing and configures its line
+int openDevice(char* devicePath){
+	int fd = open(devicePath, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	// Pseudo-terminals have no line speed to set
+	if(fd >= 0 && ciscoConfigureTerminal(fd, isatty(fd) ? baudRate : 0, flowControl)){
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+// Streams the generated configuration to the terminal device in outputPath,
+// waiting for the device prompt instead of overrunning its input buffer
+int pushConfig(plgc_t* gc){
+	int fd = openDevice(outputPath);
+	ciscopushstats_t stats;
+	ciscoconst_t retVar;
+
+	if(fd < 0){
+		printf("pushConfig: Unable to open %s\n", outputPath);
+		return CISCO_ERROR_IO;
+	}
+
+	size_t size = 0;
+	char* text = ciscoSinkGetBuffer(generatedConfig, &size);
+	ciscopush_t* push = ciscoCreatePush(fd, text, size, pushWindow, CISCO_PUSH_TIMEOUT, gc);
+
+	if(!push){
+		close(fd);
+		return CISCO_ERROR_PL32LIB_GC;
+	}
+
+	retVar = ciscoPushRun(push);
+	ciscoPushGetStats(push, &stats);
+
+	if(retVar == CISCO_ERROR_TIMEOUT){
+		printf("pushConfig: Device stopped responding after %zu of %zu lines\n", stats.linesAcked, stats.totalLines);
+	}else if(retVar){
+		printf("pushConfig: Lost connection to %s after %zu of %zu lines\n", outputPath, stats.linesAcked, stats.totalLines);
+	}
+
+	printf("pushConfig: Pushed %zu lines in %.3f s (%.1f lines/s)\n", stats.linesAcked, stats.elapsed, stats.linesPerSecond);
+	if(stats.errors)
+		printf("pushConfig: Device reported %zu errors, first on line %zu\n", stats.errors, stats.firstErrorLine);
+
+	ciscoDestroyPush(push);
+	close(fd);
+	return retVar;
+}
+
+// Renders the full output of the model next to the compact one and prints
+// how much smaller the compact one is. This renders the model a second time,
+// so it only runs with verbosity enabled
+void reportCompactSavings(plgc_t* gc){
+	size_t fullSize = snippet ? 0 : strlen("enable\nconfig t\n");
+	size_t compactSize = ciscoSinkTell(generatedConfig);
+	ciscosink_t* fullSink = ciscoCreateSink(CISCO_SINK_BUFFER, gc);
+
+	if(!fullSink)
+		return;
+
+	if(coalesce){
+		ciscoRenderModelCoalesced(model, fullSink);
+	}else{
+		ciscoRenderModel(model, fullSink);
+	}
+
+	fullSize += ciscoSinkTell(fullSink);
+	printf("generateConfig: Compact output is %zu bytes, %zu bytes (%.1f%%) less than the full output\n", compactSize, fullSize - compactSize, fullSize ? (fullSize - compactSize) * 100.0 / fullSize : 0);
+
+	ciscoDestroySink(fullSink);
+}
+
+// Prints an address issue found by a subnet check. deviceNames holds the
+// name of every device of a fleet, or is NULL for a single device
+void printSubnetIssue(const char* prefix, const ciscosubnetissue_t* issue, char** deviceNames){
+	char name[CISCO_INTNAME_MAXSIZE];
+	char otherName[CISCO_INTNAME_MAXSIZE];
+
+	ciscoFormatIntName(&issue->name, name);
+	printf("%s", prefix);
+	if(deviceNames)
+		printf("%s ", deviceNames[issue->device]);
+
+	if(issue->type == CISCO_SUBNET_GATEWAY && !issue->hasOther){
+		printf("%s gateway %s is outside every subnet of the device\n", name, issue->address);
+		return;
+	}
+
+	ciscoFormatIntName(&issue->otherName, otherName);
+
+	if(issue->type == CISCO_SUBNET_GATEWAY){
+		printf("%s gateway %s is outside %s\n", name, issue->address, issue->otherAddress);
+		return;
+	}
+
+	printf("%s %s %s ", name, issue->address, issue->type == CISCO_SUBNET_DUPLICATE ? "duplicates" : "overlaps");
+	if(deviceNames && issue->otherDevice != issue->device)
+		printf("%s ", deviceNames[issue->otherDevice]);
+
+	printf("%s %s\n", otherName, issue->otherAddress);
+}
+
+// Checks the addresses of the model for duplicates, overlapping subnets and
+// gateways outside their subnet, and prints what it finds
+void checkSubnets(){
+	const ciscosubnetissue_t* issues;
+
+	if(!subnetCheck)
+		subnetCheck = ciscoCreateSubnetCheck();
+
+	if(!subnetCheck)
+		return;
+
+	ciscoSubnetCheckReset(subnetCheck);
+	if(ciscoSubnetCheckAddModel(subnetCheck, model, 0))
+		return;
+
+	size_t issueCount = ciscoSubnetCheckRun(subnetCheck, &issues);
+
+	for(size_t i = 0; i < issueCount; i++)
+		printSubnetIssue("generateConfig: Warning: ", &issues[i], NULL);
+}
+
+int generateConfig(plarray_t* args, plgc_t* gc){
+	if(parsingBase || nonInteractive)
+		return 0;
+
+	if(verbose){
+		showConfig(NULL, gc);
+	}
+
+	checkSubnets();
+
+	if(parseOnly)
+		return 0;
+
+	size_t allocCount = ciscoGetAllocCount();
+	size_t rerendered = 0;
+
+	// Every generate replaces the previous configuration. Objects that didn't
+	// change since the last generate are spliced in from their cached output
+	ciscoSinkReset(generatedConfig);
+	ciscoSinkSetCompact(generatedConfig, compact);
+
+	if(!snippet)
+		ciscoSinkPuts(generatedConfig, compact ? "en\nconf t\n" : "enable\nconfig t\n");
+
+	// In delta mode only the changes from the base configuration are rendered
+	if(baseModel){
+		if(ciscoRenderModelDelta(baseModel, model, generatedConfig, &rerendered)){
+			printf("generateConfig: Output error\n");
+			return CISCO_ERROR_IO;
+		}
+
+		if(verbose)
+			printf("generateConfig: Rendered %zu bytes of changes to %zu ports with %zu heap allocations\n", ciscoSinkTell(generatedConfig), rerendered, ciscoGetAllocCount() - allocCount);
+	}else if(coalesce){
+		// Every table and the standalone interfaces are coalesced as a group,
+		// and only the groups that changed are coalesced again
+		if(ciscoRenderModelCoalescedCached(model, generatedConfig, &rerendered)){
+			printf("generateConfig: Output error\n");
+			return CISCO_ERROR_IO;
+		}
+
+		if(verbose)
+			printf("generateConfig: Rendered %zu bytes (%zu groups re-rendered) with %zu heap allocations\n", ciscoSinkTell(generatedConfig), rerendered, ciscoGetAllocCount() - allocCount);
+
+		if(verbose && compact)
+			reportCompactSavings(gc);
+	}else{
+		// Without coalescing every interface keeps its own cached block
+		if(ciscoRenderModelCached(model, generatedConfig, &rerendered)){
+			printf("generateConfig: Output error\n");
+			return CISCO_ERROR_IO;
+		}
+
+		if(verbose)
+			printf("generateConfig: Rendered %zu bytes (%zu objects re-rendered) with %zu heap allocations\n", ciscoSinkTell(generatedConfig), rerendered, ciscoGetAllocCount() - allocCount);
+
+		if(verbose && compact)
+			reportCompactSavings(gc);
+	}
+
+	if(verbose && ciscoGetRegion()){
+		ciscoregionstats_t stats;
+
+		ciscoRegionGetStats(ciscoGetRegion(), &stats);
+		printf("generateConfig: Memory in use %zu KiB, peak %zu KiB, %zu KiB reserved in %zu chunks, %zu allocations\n", stats.currentBytes / 1024, stats.peakBytes / 1024, stats.reservedBytes / 1024, stats.chunks, stats.allocations);
+	}
+
+	if(outputPath && isTerminal)
+		return pushConfig(gc);
+
+	if(outputPath){
+		int fd = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if(fd < 0){
+			printf("generateConfig: Unable to open %s\n", outputPath);
+			return CISCO_ERROR_IO;
+		}
+
+		size_t size = 0;
+		char* text = ciscoSinkGetBuffer(generatedConfig, &size);
+		ciscosink_t* fileSink = ciscoCreateSink(CISCO_SINK_FD, gc, fd);
+		ciscoconst_t retVar = ciscoSinkWrite(fileSink, text, size);
+
+		ciscoDestroySink(fileSink);
+		close(fd);
+
+		if(retVar){
+			printf("generateConfig: Unable to write %s\n", outputPath);
+			return retVar;
+		}
+	}
+
+	return 0;
+}
+
+// Prints which port of a command was already configured, and as what
+void printConflict(const char* command, const ciscoportconflict_t* conflict){
+	char name[CISCO_INTNAME_MAXSIZE];
+
+	ciscoFormatIntName(&conflict->name, name);
+
+	if(!conflict->number){
+		printf("%s: %s is already configured\n", command, name);
+	}else if(conflict->type == CISCO_INT_VLAN){
+		printf("%s: %s is already an access port of VLAN %u\n", command, name, conflict->number);
+	}else{
+		printf("%s: %s is already in port-channel %u\n", command, name, conflict->number);
+	}
+}
+
+int configCmdParser(plarray_t* args, plgc_t* gc){
+	char** argv = args->array;
+	char* junk;
+	if(strcmp(argv[0], "int") == 0 || strcmp(argv[0], "interface") == 0){
+		if(args->size < 2){
+			printf("%s: Not enough arguments\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		ciscointname_t names[64];
+		size_t amount = 0;
+		ciscoconst_t retVar = ciscoParseIntNames(argv[1], names, 64, &amount);
+
+		if(retVar == CISCO_ERROR_BUFFER_OVERFLOW){
+			printf("%s: Too many interfaces in list\n", argv[0]);
+			return retVar;
+		}else if(retVar){
+			printf("%s: Invalid interface\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+
+		ciscoint_t* interfaces[64];
+
+		for(size_t i = 0; i < amount; i++){
+			ciscoint_t* interface = ciscoCreateInterfaceFromName(&names[i], gc);
+			interfaces[i] = interface;
+
+			if(args->size >= 3){
+				retVar = ciscoModifyInterface(interface, gc, CISCO_MODTYPE_MODE, ciscoStringToMode(argv[2]));
+				if(retVar == CISCO_ERROR_INVALID_VALUE){
+					printf("%s: Invalid value\n", argv[0]);
+					return retVar;
+				}
+			}
+
+			if(args->size >= 4){
+				retVar = ciscoModifyInterface(interface, gc, CISCO_MODTYPE_IP_ADDR, argv[3]);
+				if(retVar == CISCO_ERROR_MISMATCHED_IPVER){
+					printf("%s: Mismatched IP version\n", argv[0]);
+					return retVar;
+				}else if(retVar){
+					printf("%s: Invalid IP address\n", argv[0]);
+					return retVar;
+				}
+			}
+
+			if(args->size >= 5){
+				uint8_t subMask = strtol(argv[4], &junk, 10);
+
+				retVar = ciscoModifyInterface(interface, gc, CISCO_MODTYPE_SUBMASK, subMask);
+				if(retVar == CISCO_ERROR_OUT_OF_RANGE){
+					printf("%s: Out of range\n", argv[0]);
+					return retVar;
+				}
+			}
+
+			if(args->size >= 6){
+				retVar = ciscoModifyInterface(interface, gc, CISCO_MODTYPE_DESC_INTERNED, argv[5], ciscoModelGetStringPool(model));
+				if(retVar == CISCO_ERROR_BUFFER_OVERFLOW){
+					printf("%s: Buffer overflow", argv[0]);
+					return retVar;
+				}
+			}
+		}
+
+		retVar = ciscoModelAddInterfaces(model, interfaces, amount);
+
+		if(retVar == CISCO_ERROR_CONFLICT){
+			printConflict(argv[0], ciscoModelGetConflict(model));
+			return retVar;
+		}else if(retVar){
+			printf("%s: Internal pl32lib error\n", argv[0]);
+			return CISCO_ERROR_PL32LIB_GC;
+		}
+	}else if(strcmp(argv[0], "vlan") == 0 || strcmp(argv[0], "ether") == 0){
+		if(args->size < 2){
+			printf("%s: Not enough args\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		bool isVlan = strcmp(argv[0], "vlan") == 0;
+		uint16_t number = strtol(argv[1], &junk, 10);
+		size_t portsArg = isVlan ? 3 : 2;
+		ciscoconst_t mode = CISCO_ERROR_INVALID_VALUE;
+		ciscoconst_t type = isVlan ? CISCO_INT_VLAN : CISCO_INT_PORTCH;
+
+		// Repeated lines for the same VLAN or EtherChannel add to the table already in the model
+		ciscotable_t* table = ciscoModelFindTable(model, type, number);
+		bool created = !table;
+
+		if(created)
+			table = ciscoCreateTable(type, CISCO_MODE_AUTO, number, gc);
+
+		if(isVlan && args->size > 2 && ciscoModifyTable(table, gc, CISCO_MODTYPE_NAME, argv[2])){
+			printf("%s: Buffer overflow\n", argv[0]);
+			return CISCO_ERROR_BUFFER_OVERFLOW;
+		}
+
+		// The mode applies to the member ports of a VLAN and to the channel itself for an EtherChannel
+		if(args->size > portsArg + 1 && strcmp(argv[portsArg + 1], "nomode") != 0){
+			mode = ciscoStringToMode(argv[portsArg + 1]);
+
+			if(mode == CISCO_ERROR_INVALID_VALUE || (isVlan && mode != CISCO_MODE_ACCESS && mode != CISCO_MODE_TRUNK)){
+				printf("%s: Invalid value\n", argv[0]);
+				return CISCO_ERROR_INVALID_VALUE;
+			}
+
+			if(!isVlan)
+				ciscoModifyTable(table, gc, CISCO_MODTYPE_MODE, mode);
+		}
+
+		if(args->size > portsArg && strcmp(argv[portsArg], "noport") != 0){
+			ciscointname_t names[64];
+			size_t amount = 0;
+
+			if(ciscoParseIntNames(argv[portsArg], names, 64, &amount)){
+				printf("%s: Invalid interface\n", argv[0]);
+				return CISCO_ERROR_INVALID_VALUE;
+			}
+
+			ciscoint_t* interfaces[64];
+
+			for(size_t i = 0; i < amount; i++){
+				interfaces[i] = ciscoCreateInterfaceFromName(&names[i], gc);
+
+				if(isVlan && mode != CISCO_ERROR_INVALID_VALUE)
+					ciscoModifyInterface(interfaces[i], gc, CISCO_MODTYPE_MODE, mode);
+			}
+
+			// New tables claim their ports once they are added to the model
+			int retVar = created ? ciscoAddInterfaces(table, interfaces, amount, gc) : ciscoModelAddTableInterfaces(model, table, interfaces, amount);
+
+			if(retVar == CISCO_ERROR_CONFLICT){
+				printConflict(argv[0], ciscoModelGetConflict(model));
+				return retVar;
+			}else if(retVar){
+				printf("%s: Internal pl32lib error\n", argv[0]);
+				return CISCO_ERROR_PL32LIB_GC;
+			}
+		}
+
+		if(created){
+			int retVar = ciscoModelAddTable(model, table);
+
+			if(retVar == CISCO_ERROR_CONFLICT){
+				printConflict(argv[0], ciscoModelGetConflict(model));
+				return retVar;
+			}else if(retVar){
+				printf("%s: Internal pl32lib error\n", argv[0]);
+				return CISCO_ERROR_PL32LIB_GC;
+			}
+		}
+	}else if(strcmp(argv[0], "allow") == 0){
+		plarray_t* modelInts = ciscoModelGetInterfaces(model);
+		bool except = args->size >= 3 && strcmp(argv[1], "except") == 0;
+		ciscovlanset_t vlanSet;
+
+		if(args->size < 2 || (except && args->size < 3)){
+			printf("%s: Not enough args\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		if(modelInts->size == 0){
+			printf("%s: No interface to apply to\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		ciscoVlanSetClear(&vlanSet);
+		if(ciscoVlanSetParse(&vlanSet, except ? argv[2] : argv[1])){
+			printf("%s: Invalid VLAN list\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+
+		if(except){
+			ciscovlanset_t exceptSet = vlanSet;
+			ciscoVlanSetExcept(&vlanSet, &exceptSet);
+		}
+
+		ciscoint_t* interface = ((ciscoint_t**)modelInts->array)[modelInts->size - 1];
+		if(ciscoModifyInterface(interface, gc, CISCO_MODTYPE_ALLOW_VLAN_SET, &vlanSet)){
+			printf("%s: Internal pl32lib error\n", argv[0]);
+			return CISCO_ERROR_PL32LIB_GC;
+		}
+	}
+
+	return 0;
+}
+
+// Gives the addresses handed out to the first count interfaces of an addr
+// line back to their pool
+void releaseAddresses(ciscopool_t* pool, ciscoip_t* addresses, size_t count, bool isHost){
+	for(size_t i = 0; i < count; i++){
+		ciscoip_t block;
+
+		if(isHost){
+			block = addresses[i];
+			block.prefix = block.isIPv6 ? 128 : 32;
+		}else{
+			ciscoIPNetwork(&addresses[i], &block);
+		}
+
+		ciscoPoolRelease(pool, &block);
+	}
+}
+
+// Runs the address pool commands. They are never run by parse chunks, since
+// every address handed out depends on all the ones before it
+int poolCmdParser(plarray_t* args, plgc_t* gc){
+	char** argv = args->array;
+	char* junk;
+
+	if(strcmp(argv[0], "pool") == 0){
+		ciscoip_t prefix;
+
+		if(args->size < 3){
+			printf("%s: Not enough arguments\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		if(!strchr(argv[2], '/') || ciscoParseIP(argv[2], &prefix)){
+			printf("%s: Invalid prefix\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+
+		ciscopool_t* pool = ciscoCreatePool(argv[1], &prefix, gc);
+
+		if(ciscoModelAddPool(model, pool)){
+			printf("%s: Pool %s already exists\n", argv[0], argv[1]);
+			ciscoDestroyPool(pool);
+			return CISCO_ERROR_CONFLICT;
+		}
+	}else if(strcmp(argv[0], "addr") == 0){
+		if(args->size < 4){
+			printf("%s: Not enough arguments\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		ciscopool_t* pool = ciscoModelFindPool(model, argv[3]);
+
+		if(!pool){
+			printf("%s: No pool named %s\n", argv[0], argv[3]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+
+		const ciscoip_t* poolPrefix = ciscoPoolGetPrefix(pool);
+		uint8_t width = poolPrefix->isIPv6 ? 128 : 32;
+		long length = width;
+
+		if(args->size >= 5){
+			length = strtol(argv[4], &junk, 10);
+
+			if(*junk != '\0' || length < poolPrefix->prefix || length > width){
+				printf("%s: Out of range\n", argv[0]);
+				return CISCO_ERROR_OUT_OF_RANGE;
+			}
+		}
+
+		ciscoconst_t mode = ciscoStringToMode(argv[2]);
+
+		if(mode == CISCO_ERROR_INVALID_VALUE){
+			printf("%s: Invalid value\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+
+		ciscointname_t names[64];
+		size_t amount = 0;
+		ciscoconst_t retVar = ciscoParseIntNames(argv[1], names, 64, &amount);
+
+		if(retVar == CISCO_ERROR_BUFFER_OVERFLOW){
+			printf("%s: Too many interfaces in list\n", argv[0]);
+			return retVar;
+		}else if(retVar){
+			printf("%s: Invalid interface\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+
+		// Every port of a range gets an address of its own
+		size_t portCount = 0;
+		bool isHost = args->size < 5;
+		for(size_t i = 0; i < amount; i++)
+			portCount += names[i].lastPort - names[i].port + 1;
+
+		// Host addresses share the subnet of the pool, which IOS only allows
+		// on one interface of a device
+		if(isHost && portCount > 1){
+			printf("%s: A prefix length is needed to number more than one port\n", argv[0]);
+			return CISCO_ERROR_INVALID_ACTION;
+		}
+
+		ciscoint_t** interfaces = plGCAlloc(gc, portCount * sizeof(ciscoint_t*));
+		ciscoip_t* addresses = plGCAlloc(gc, portCount * sizeof(ciscoip_t));
+		size_t count = 0;
+
+		for(size_t i = 0; i < amount && !retVar; i++){
+			for(uint32_t port = names[i].port; port <= names[i].lastPort && !retVar; port++){
+				ciscointname_t name = names[i];
+				char addrString[CISCO_ADDR_MAXSTRING];
+
+				name.port = port;
+				name.lastPort = port;
+				retVar = isHost ? ciscoPoolAllocateHost(pool, &addresses[count]) : ciscoPoolAllocateSubnet(pool, length, &addresses[count]);
+
+				if(retVar == CISCO_ERROR_OUT_OF_RANGE){
+					printf("%s: Pool %s is out of addresses\n", argv[0], argv[3]);
+					break;
+				}else if(retVar){
+					printf("%s: Internal pl32lib error\n", argv[0]);
+					break;
+				}
+
+				interfaces[count] = ciscoCreateInterfaceFromName(&name, gc);
+				count++;
+
+				ciscoFormatIP(&addresses[count - 1], addrString);
+				ciscoModifyInterface(interfaces[count - 1], gc, CISCO_MODTYPE_MODE, mode);
+				ciscoModifyInterface(interfaces[count - 1], gc, CISCO_MODTYPE_IP_ADDR, addrString);
+
+				if(args->size >= 6 && ciscoModifyInterface(interfaces[count - 1], gc, CISCO_MODTYPE_DESC_INTERNED, argv[5], ciscoModelGetStringPool(model))){
+					printf("%s: Buffer overflow\n", argv[0]);
+					retVar = CISCO_ERROR_BUFFER_OVERFLOW;
+				}
+			}
+		}
+
+		if(!retVar){
+			retVar = ciscoModelAddInterfaces(model, interfaces, count);
+
+			if(retVar == CISCO_ERROR_CONFLICT){
+				printConflict(argv[0], ciscoModelGetConflict(model));
+			}else if(retVar){
+				printf("%s: Internal pl32lib error\n", argv[0]);
+				retVar = CISCO_ERROR_PL32LIB_GC;
+			}
+		}
+
+		// A line that fails hands out nothing
+		if(retVar)
+			releaseAddresses(pool, addresses, count, isHost);
+
+		plGCFree(gc, addresses);
+		plGCFree(gc, interfaces);
+
+		return retVar;
+	}
+
+	return 0;
+}
+
+// Runs the port profile commands. Like the address pool commands they are
+// never run by parse chunks
+int profileCmdParser(plarray_t* args, plgc_t* gc){
+	char** argv = args->array;
+	char* junk;
+
+	if(args->size < 3){
+		printf("%s: Not enough arguments\n", argv[0]);
+		return CISCO_ERROR_INVALID_ACTION;
+	}
+
+	bool isProfile = strcmp(argv[0], "profile") == 0;
+	ciscoprofile_t* profile = NULL;
+	ciscointname_t names[64];
+	size_t amount = 0;
+
+	if(strcmp(argv[0], "apply") == 0){
+		profile = ciscoModelFindProfile(model, argv[1]);
+
+		if(!profile){
+			printf("%s: No profile named %s\n", argv[0], argv[1]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+	}
+
+	// apply and override take interfaces, profile takes a name
+	if(!isProfile){
+		ciscoconst_t retVar = ciscoParseIntNames(argv[profile ? 2 : 1], names, 64, &amount);
+
+		if(retVar == CISCO_ERROR_BUFFER_OVERFLOW){
+			printf("%s: Too many interfaces in list\n", argv[0]);
+			return retVar;
+		}else if(retVar){
+			printf("%s: Invalid interface\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+	}
+
+	if(profile){
+		int retVar = ciscoModelApplyProfile(model, profile, names, amount);
+
+		if(retVar == CISCO_ERROR_CONFLICT){
+			printConflict(argv[0], ciscoModelGetConflict(model));
+			return retVar;
+		}else if(retVar){
+			printf("%s: Internal pl32lib error\n", argv[0]);
+			return CISCO_ERROR_PL32LIB_GC;
+		}
+
+		return 0;
+	}
+
+	// profile and override share the rest of their arguments. The VLAN is
+	// the allowed VLAN list of a trunk and the access VLAN of anything else
+	ciscoportsettings_t settings;
+	ciscovlanset_t vlanSet;
+
+	memset(&settings, 0, sizeof(ciscoportsettings_t));
+
+	if(strcmp(argv[2], "nomode") != 0){
+		settings.mode = ciscoStringToMode(argv[2]);
+
+		if(settings.mode != CISCO_MODE_ACCESS && settings.mode != CISCO_MODE_TRUNK){
+			printf("%s: Invalid value\n", argv[0]);
+			return CISCO_ERROR_INVALID_VALUE;
+		}
+	}
+
+	if(args->size >= 4 && strcmp(argv[3], "novlan") != 0){
+		if(settings.mode == CISCO_MODE_TRUNK){
+			ciscoVlanSetClear(&vlanSet);
+
+			if(ciscoVlanSetParse(&vlanSet, argv[3])){
+				printf("%s: Invalid VLAN list\n", argv[0]);
+				return CISCO_ERROR_INVALID_VALUE;
+			}
+
+			settings.allowedVlans = &vlanSet;
+		}else{
+			long vlan = strtol(argv[3], &junk, 10);
+
+			if(*junk != '\0' || vlan < 1 || vlan > CISCO_VLAN_MAX){
+				printf("%s: Out of range\n", argv[0]);
+				return CISCO_ERROR_OUT_OF_RANGE;
+			}
+
+			settings.vlan = vlan;
+		}
+	}
+
+	if(args->size >= 5)
+		settings.description = argv[4];
+
+	int retVar = isProfile ? ciscoModelAddProfile(model, argv[1], &settings) : ciscoModelOverridePorts(model, names, amount, &settings);
+
+	if(retVar == CISCO_ERROR_CONFLICT){
+		printf("%s: Profile %s already exists\n", argv[0], argv[1]);
+	}else if(retVar == CISCO_ERROR_INVALID_ACTION){
+		printf("%s: Not every port of %s has a profile\n", argv[0], argv[1]);
+	}else if(retVar == CISCO_ERROR_BUFFER_OVERFLOW){
+		printf("%s: Buffer overflow\n", argv[0]);
+	}else if(retVar){
+		printf("%s: Internal pl32lib error\n", argv[0]);
+		retVar = CISCO_ERROR_PL32LIB_GC;
+	}
+
+	return retVar;
+}
+
+// Runs an already tokenized source line. Commands in commandBuf are called
+// directly with the tokens, anything else (comments, shell builtins) is
+// joined back into a line and handed to plShell
+uint8_t runCommand(plarray_t* args, plarray_t* variableBuf, plarray_t* commandBuf, plgc_t* gc){
+	char** argv = args->array;
+	plfunctionptr_t* commands = commandBuf->array;
+
+	if(args->size == 0 || argv[0][0] == '#')
+		return 0;
+
+	for(size_t i = 0; i < commandBuf->size; i++){
+		if(strcmp(commands[i].name, argv[0]) == 0)
+			return commands[i].function(args, gc);
+	}
+
+	size_t lineSize = 1;
+	for(size_t i = 0; i < args->size; i++)
+		lineSize += strlen(argv[i]) + 3;
+
+	char* cmdline = plGCAlloc(gc, lineSize);
+	char* pointer = cmdline;
+	for(size_t i = 0; i < args->size; i++){
+		bool quoted = strpbrk(argv[i], " \t") != NULL;
+		pointer += sprintf(pointer, quoted ? "%s\"%s\"" : "%s%s", i ? " " : "", argv[i]);
+	}
+
+	uint8_t retVar = plShell(cmdline, variableBuf, commandBuf, gc);
+	plGCFree(gc, cmdline);
+	return retVar;
+}
+
+// Checks if the result of a command fails the source line it came from.
+// Outside of the interactive shell, commands plShell doesn't know fail too
+bool commandFailed(uint8_t retVar){
+	return (retVar >= CISCO_ERROR_INVALID_ACTION && retVar <= CISCO_ERROR_CONFLICT) || (nonInteractive && retVar == 255);
+}
+
+// Runs every line of a source file. Returns the number of the first line that
+// failed with a ciscolib error, 0 if none did, or -1 if the file could not be
+// opened
+long parseSource(char* sourcePath, plarray_t* variableBuf, plarray_t* commandBuf, plgc_t* gc){
+	ciscosource_t* source = ciscoOpenSource(sourcePath, gc);
+	plarray_t* args;
+	long failedLine = 0;
+
+	if(!source)
+		return -1;
+
+	ciscoStatsBegin(CISCO_PHASE_PARSE);
+
+	while((args = ciscoSourceNextLine(source)) != NULL){
+		uint8_t retVar = runCommand(args, variableBuf, commandBuf, gc);
+
+		if(!failedLine && commandFailed(retVar))
+			failedLine = ciscoSourceGetLine(source);
+	}
+
+	ciscoStatsEnd(CISCO_PHASE_PARSE, ciscoSourceGetLine(source), ciscoSourceGetSize(source));
+	ciscoCloseSource(source);
+	return failedLine;
+}
+
+// Checks whether a source line is an int command. Parse chunks only start on
+// these lines, so allow always finds its interface in the same chunk
+bool isIntLine(const char* line, const char* end){
+	size_t wordSize = 0;
+
+	while(line < end && (*line == ' ' || *line == '\t'))
+		line++;
+
+	while(line + wordSize < end && !isspace((unsigned char)line[wordSize]))
+		wordSize++;
+
+	return (wordSize == 3 && memcmp(line, "int", 3) == 0) || (wordSize == 9 && memcmp(line, "interface", 9) == 0);
+}
+
+// Finds where a parse chunk that should end around target actually ends: at
+// the start of the first int line after it, or at the end of the source
+size_t findChunkEnd(const char* data, size_t size, size_t target){
+	size_t offset = target;
+
+	while(offset < size){
+		const char* lineEnd = memchr(data + offset, '\n', size - offset);
+
+		if(!lineEnd)
+			return size;
+
+		offset = lineEnd - data + 1;
+		if(offset < size && isIntLine(data + offset, data + size))
+			return offset;
+	}
+
+	return size;
+}
+
+// Parse worker thread. Runs the parser commands of a chunk into its partial
+// model and defers everything else to the merge
+void* parseWorker(void* arg){
+	parsechunk_t* chunk = arg;
+	plfunctionptr_t* commands = chunk->commandBuf->array;
+	plarray_t* args;
+
+	ciscoUseRegion(chunk->region);
+	chunk->slice = ciscoSourceSlice(chunk->source, chunk->start, chunk->end, chunk->gc);
+	chunk->model = ciscoCreateModel(chunk->gc);
+	ciscoVectorInit(&chunk->deferred, sizeof(deferredcmd_t), 8, chunk->gc);
+	model = chunk->model;
+
+	while((args = ciscoSourceNextLine(chunk->slice)) != NULL){
+		char** argv = args->array;
+		long lineNum = ciscoSourceGetLine(chunk->slice);
+		size_t i = 0;
+
+		if(args->size == 0 || argv[0][0] == '#')
+			continue;
+
+		while(i < chunk->commandBuf->size && (commands[i].function != configCmdParser || strcmp(commands[i].name, argv[0]) != 0))
+			i++;
+
+		if(i < chunk->commandBuf->size){
+			uint8_t retVar = configCmdParser(args, chunk->gc);
+
+			if(!chunk->failedLine && commandFailed(retVar))
+				chunk->failedLine = lineNum;
+
+			continue;
+		}
+
+		// The tokens stay valid as long as the source, only the array is reused
+		deferredcmd_t command;
+		command.args.array = plGCAlloc(chunk->gc, (args->size + 1) * sizeof(char*));
+		memcpy(command.args.array, args->array, (args->size + 1) * sizeof(char*));
+		command.args.size = args->size;
+		command.lineNum = lineNum;
+		command.intCount = ciscoModelGetInterfaces(model)->size;
+		command.tableCount = ciscoModelGetTables(model)->size;
+		ciscoVectorPush(&chunk->deferred, &command);
+	}
+
+	chunk->lineCount = ciscoSourceGetLine(chunk->slice);
+	ciscoCloseSource(chunk->slice);
+	ciscoUseRegion(NULL);
+	model = NULL;
+
+	return NULL;
+}
+
+// Parses a source on up to threadCount threads. The source is split into
+// chunks that start on int lines, every chunk is parsed into a partial model,
+// and the partial models are appended to the model in source order. Commands
+// other than the parser ones run during the merge, once everything before them
+// has been merged. Chunks that can't get a thread are parsed on the calling
+// one. The memory of every chunk is added to chunkMemory if given, and is
+// otherwise kept for as long as the program runs, unless the source had to be
+// parsed serially after all. Returns the same as parseSource()
+long parseSourceParallel(char* sourcePath, long threadCount, plarray_t* variableBuf, plarray_t* commandBuf, ciscovector_t* chunkMemory, plgc_t* gc){
+	ciscosource_t* source = ciscoOpenSource(sourcePath, gc);
+
+	if(!source)
+		return -1;
+
+	// Only the calling thread records stats, so everything the workers do
+	// counts as parsing
+	ciscoStatsBegin(CISCO_PHASE_PARSE);
+
+	const char* data = ciscoSourceGetData(source);
+	size_t size = ciscoSourceGetSize(source);
+	parsechunk_t* chunks = plGCCalloc(gc, threadCount, sizeof(parsechunk_t));
+	pthread_t* threads = plGCAlloc(gc, threadCount * sizeof(pthread_t));
+	size_t chunkCount = 0;
+	size_t start = 0;
+
+	// Chunk boundaries have to be found before any chunk is tokenized
+	while(start < size){
+		size_t end = findChunkEnd(data, size, start + (size - start) / (threadCount - chunkCount));
+		parsechunk_t* chunk = &chunks[chunkCount];
+
+		if(chunkCount + 1 == (size_t)threadCount)
+			end = size;
+
+		chunk->gc = plGCInit(8 * 1024 * 1024);
+		chunk->region = ciscoCreateRegion(0);
+		chunk->source = source;
+		chunk->start = start;
+		chunk->end = end;
+		chunk->commandBuf = commandBuf;
+
+		if(chunkMemory){
+			chunkmemory_t memory = { chunk->gc, chunk->region };
+			ciscoVectorPush(chunkMemory, &memory);
+		}
+
+		chunkCount++;
+		start = end;
+	}
+
+	for(size_t i = 0; i < chunkCount; i++)
+		chunks[i].threaded = pthread_create(&threads[i], NULL, parseWorker, &chunks[i]) == 0;
+
+	// A chunk that didn't get a thread is parsed on this one instead, which
+	// mustn't lose its own model, region or stats to the worker
+	for(size_t i = 0; i < chunkCount; i++){
+		if(chunks[i].threaded)
+			continue;
+
+		ciscomodel_t* callerModel = model;
+		ciscoregion_t* callerRegion = ciscoGetRegion();
+		ciscostats_t* callerStats = ciscoUseStats(NULL);
+
+		parseWorker(&chunks[i]);
+		ciscoUseStats(callerStats);
+		ciscoUseRegion(callerRegion);
+		model = callerModel;
+	}
+
+	for(size_t i = 0; i < chunkCount; i++){
+		if(chunks[i].threaded)
+			pthread_join(threads[i], NULL);
+	}
+
+	// Every chunk only checked its own ports. A port claimed by two chunks has
+	// to be reported with the line that claimed it second, which only the
+	// serial parser knows, so such a source is parsed again without threads.
+	// So are sources with addr or apply lines, whose ports are only claimed
+	// at merge
+	ciscoportindex_t* ports = ciscoCreatePortIndex(gc);
+	bool conflicts = false;
+
+	for(size_t i = 0; i < chunkCount && !conflicts; i++){
+		for(size_t j = 0; j < chunks[i].deferred.items.size && !conflicts; j++){
+			char** argv = ((deferredcmd_t*)ciscoVectorAt(&chunks[i].deferred, j))->args.array;
+			conflicts = strcmp(argv[0], "addr") == 0 || strcmp(argv[0], "apply") == 0;
+		}
+	}
+
+	for(size_t i = 0; i < chunkCount && !conflicts; i++){
+		plarray_t* partialInts = ciscoModelGetInterfaces(chunks[i].model);
+		plarray_t* partialTables = ciscoModelGetTables(chunks[i].model);
+
+		conflicts = ciscoPortIndexClaim(ports, NULL, partialInts->array, partialInts->size, NULL) != 0;
+
+		for(size_t j = 0; j < partialTables->size && !conflicts; j++)
+			conflicts = ciscoPortIndexAddTable(ports, ((ciscotable_t**)partialTables->array)[j], NULL) != 0;
+	}
+
+	ciscoDestroyPortIndex(ports);
+
+	if(conflicts){
+		ciscoStatsEnd(CISCO_PHASE_PARSE, 0, 0);
+
+		// The partial models are thrown away, so unless the caller frees the
+		// memory of the chunks, it is freed here
+		for(size_t i = 0; i < chunkCount && !chunkMemory; i++){
+			plGCStop(chunks[i].gc);
+			ciscoDestroyRegion(chunks[i].region);
+		}
+
+		plGCFree(gc, threads);
+		plGCFree(gc, chunks);
+		ciscoCloseSource(source);
+
+		return parseSource(sourcePath, variableBuf, commandBuf, gc);
+	}
+
+	long failedLine = 0;
+	long lineBase = 0;
+	size_t intTotal = 0;
+	size_t tableTotal = 0;
+
+	for(size_t i = 0; i < chunkCount; i++){
+		intTotal += ciscoModelGetInterfaces(chunks[i].model)->size;
+		tableTotal += ciscoModelGetTables(chunks[i].model)->size;
+	}
+
+	ciscoModelReserve(model, intTotal, tableTotal);
+
+	for(size_t i = 0; i < chunkCount; i++){
+		parsechunk_t* chunk = &chunks[i];
+		plarray_t* partialInts = ciscoModelGetInterfaces(chunk->model);
+		plarray_t* partialTables = ciscoModelGetTables(chunk->model);
+		size_t mergedInts = 0;
+		size_t mergedTables = 0;
+
+		if(chunk->failedLine && (!failedLine || lineBase + chunk->failedLine < failedLine))
+			failedLine = lineBase + chunk->failedLine;
+
+		// One extra pass merges whatever is left after the last deferred command
+		for(size_t j = 0; j <= chunk->deferred.items.size; j++){
+			deferredcmd_t* command = ciscoVectorAt(&chunk->deferred, j);
+			size_t intCount = command ? command->intCount : partialInts->size;
+			size_t tableCount = command ? command->tableCount : partialTables->size;
+
+			ciscoModelAddInterfaces(model, (ciscoint_t**)partialInts->array + mergedInts, intCount - mergedInts);
+
+			// Tables split across chunks fold into the first one
+			for(size_t k = mergedTables; k < tableCount; k++)
+				ciscoModelMergeTable(model, ((ciscotable_t**)partialTables->array)[k]);
+
+			mergedInts = intCount;
+			mergedTables = tableCount;
+
+			if(!command)
+				continue;
+
+			uint8_t retVar = runCommand(&command->args, variableBuf, commandBuf, gc);
+
+			if(commandFailed(retVar) && (!failedLine || lineBase + command->lineNum < failedLine))
+				failedLine = lineBase + command->lineNum;
+		}
+
+		lineBase += chunk->lineCount;
+	}
+
+	ciscoStatsEnd(CISCO_PHASE_PARSE, lineBase, size);
+	plGCFree(gc, threads);
+	plGCFree(gc, chunks);
+	ciscoCloseSource(source);
+
+	return failedLine;
+}
+
+// Prints the phases recorded in runStats along with the memory ciscolib used,
+// as a table or as a JSON object
+void printStats(){
+	ciscophasestats_t total = { 0 };
+	ciscoregionstats_t region = { 0 };
+	size_t written = 0;
+
+	if(ciscoGetRegion())
+		ciscoRegionGetStats(ciscoGetRegion(), &region);
+
+	if(statsJson){
+		fprintf(stderr, "{\"phases\":{");
+	}else{
+		fprintf(stderr, "%-18s %10s %10s %8s %10s %10s %10s %12s\n", "phase", "wall (ms)", "cpu (ms)", "calls", "items", "allocs", "alloc KiB", "bytes");
+	}
+
+	for(ciscoconst_t phase = CISCO_PHASE_READ; phase < CISCO_PHASE_READ + CISCO_PHASE_COUNT; phase++){
+		ciscophasestats_t phaseStats;
+
+		ciscoStatsGetPhase(runStats, phase, &phaseStats);
+		total.wallTime += phaseStats.wallTime;
+		total.cpuTime += phaseStats.cpuTime;
+		total.calls += phaseStats.calls;
+		total.allocations += phaseStats.allocations;
+		total.allocBytes += phaseStats.allocBytes;
+
+		if(phase == CISCO_PHASE_WRITE)
+			written = phaseStats.bytes;
+
+		if(statsJson){
+			fprintf(stderr, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"calls\":%zu,\"items\":%zu,\"allocations\":%zu,\"alloc_bytes\":%zu,\"bytes\":%zu}", phase == CISCO_PHASE_READ ? "" : ",", ciscoStatsPhaseName(phase), phaseStats.wallTime * 1000, phaseStats.cpuTime * 1000, phaseStats.calls, phaseStats.items, phaseStats.allocations, phaseStats.allocBytes, phaseStats.bytes);
+		}else{
+			fprintf(stderr, "%-18s %10.3f %10.3f %8zu %10zu %10zu %10zu %12zu\n", ciscoStatsPhaseName(phase), phaseStats.wallTime * 1000, phaseStats.cpuTime * 1000, phaseStats.calls, phaseStats.items, phaseStats.allocations, phaseStats.allocBytes / 1024, phaseStats.bytes);
+		}
+	}
+
+	if(statsJson){
+		fprintf(stderr, "},\"total\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"allocations\":%zu,\"alloc_bytes\":%zu},", total.wallTime * 1000, total.cpuTime * 1000, total.allocations, total.allocBytes);
+		fprintf(stderr, "\"memory\":{\"allocations\":%zu,\"alloc_bytes\":%zu,\"region_bytes\":%zu,\"region_peak_bytes\":%zu,\"region_reserved_bytes\":%zu,\"region_chunks\":%zu},", ciscoGetAllocCount(), ciscoGetAllocBytes(), region.currentBytes, region.peakBytes, region.reservedBytes, region.chunks);
+		fprintf(stderr, "\"output\":{\"generated_bytes\":%zu,\"written_bytes\":%zu}}\n", ciscoSinkTell(generatedConfig), written);
+	}else{
+		fprintf(stderr, "%-18s %10.3f %10.3f %8s %10s %10zu %10zu %12s\n", "total", total.wallTime * 1000, total.cpuTime * 1000, "", "", total.allocations, total.allocBytes / 1024, "");
+		fprintf(stderr, "Memory: %zu allocations (%zu KiB), %zu KiB in use, peak %zu KiB, %zu KiB reserved in %zu chunks\n", ciscoGetAllocCount(), ciscoGetAllocBytes() / 1024, region.currentBytes / 1024, region.peakBytes / 1024, region.reservedBytes / 1024, region.chunks);
+		fprintf(stderr, "Output: %zu bytes generated, %zu bytes written\n", ciscoSinkTell(generatedConfig), written);
+	}
+}
+
+// Parses and renders one source file of a batch run into its output file.
+// Its addresses are added to the subnet check of the whole batch
+void runBatchJob(batchqueue_t* queue, size_t index){
+	batchjob_t* job = &queue->jobs[index];
+	plarray_t* commandBuf = queue->commandBuf;
+	struct timespec start;
+	struct timespec end;
+	plarray_t variableBuf;
+	variableBuf.array = NULL;
+	variableBuf.size = 0;
+
+	// Another source of the batch already writes this output file
+	if(job->sameOutput)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// Everything ciscolib allocates for the job comes from the worker's
+	// region, which is reset once the job is done
+	plgc_t* jobGC = plGCInit(8 * 1024 * 1024);
+	model = ciscoCreateModel(jobGC);
+	long retVar = parseSource(job->sourcePath, &variableBuf, commandBuf, jobGC);
+
+	if(retVar < 0){
+		job->status = CISCO_ERROR_IO;
+	}else if(retVar > 0){
+		job->status = CISCO_ERROR_INVALID_VALUE;
+		job->failedLine = retVar;
+	}else{
+		int fd = open(job->outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		if(fd < 0){
+			job->status = CISCO_ERROR_IO;
+		}else{
+			ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_FD, jobGC, fd);
+
+			if(!snippet)
+				ciscoSinkPuts(sink, compact ? "en\nconf t\n" : "enable\nconfig t\n");
+
+			ciscoSinkSetCompact(sink, compact);
+			job->status = coalesce ? ciscoRenderModelCoalesced(model, sink) : ciscoRenderModel(model, sink);
+			if(!job->status)
+				job->status = ciscoSinkFlush(sink);
+
+			job->outputSize = ciscoSinkTell(sink);
+			ciscoDestroySink(sink);
+			close(fd);
+		}
+
+		pthread_mutex_lock(&queue->lock);
+		ciscoSubnetCheckAddModel(queue->subnets, model, index);
+		pthread_mutex_unlock(&queue->lock);
+	}
+
+	plGCStop(jobGC);
+	model = NULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	job->elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Batch worker thread. Takes jobs off the shared queue until it is empty
+void* batchWorker(void* arg){
+	batchqueue_t* queue = arg;
+	ciscoregion_t* region = ciscoCreateRegion(0);
+	ciscoregionstats_t stats;
 
-int showConfig(plarray_t* args, plgc_t* gc){
-	char** argv = args->array;
-	if(args->size > 1 && strcmp(argv[1], "gen-conf") == 0){
-		plFSeek(generatedConfig, 0, SEEK_SET);
-		char text[4096] = "";
-		while(plFGets(text, 4095, generatedConfig) != NULL)
-			printf("%s", text);
-	}else{
-		ciscoint_t** interfaceArr = interfaces->array;
-		ciscotable_t** tableArr = tables->array;
+	ciscoUseRegion(region);
 
-		for(int i = 0; i < interfaces->size; i++){
-			ciscoPrintInterface(interfaceArr[i], gc);
-		}
+	while(true){
+		pthread_mutex_lock(&queue->lock);
+		size_t index = queue->next;
+		queue->next++;
+		pthread_mutex_unlock(&queue->lock);
 
-		for(int i = 0; i < tables->size; i++){
-			ciscoPrintTable(tableArr[i], gc);
-		}
+		if(index >= queue->size)
+			break;
+
+		runBatchJob(queue, index);
+
+		ciscoRegionGetStats(region, &stats);
+		queue->jobs[index].peakBytes = stats.peakBytes;
+		ciscoRegionReset(region);
 	}
+
+	ciscoRegionGetStats(region, &stats);
+	pthread_mutex_lock(&queue->lock);
+	if(stats.reservedBytes > queue->reservedBytes)
+		queue->reservedBytes = stats.reservedBytes;
+	pthread_mutex_unlock(&queue->lock);
+
+	ciscoUseRegion(NULL);
+	ciscoDestroyRegion(region);
+
+	return NULL;
 }
 
-int generateConfig(plarray_t* args, plgc_t* gc){
-	ciscoint_t** interfaceArr = interfaces->array;
-	ciscotable_t** tableArr = tables->array;
+// Gets the current monotonic time in seconds
+double getTime(){
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
 
-	plarray_t generatedSnippets;
-	generatedSnippets.array = plGCAlloc(gc, 2 * sizeof(plfile_t*));
-	generatedSnippets.size = 0;
+void printBenchPhase(char* name, double elapsed, size_t lines, size_t bytes){
+	printf("%-18s %12.3f %14.0f %10.2f\n", name, elapsed * 1000, elapsed > 0 ? lines / elapsed : 0, elapsed > 0 ? bytes / elapsed / (1024 * 1024) : 0);
+}
 
-	if(verbose){
-		showConfig(NULL, gc);
+// Times every stage of a run separately: reading the source, tokenizing it,
+// dispatching it to the parser commands, rendering and writing the output
+int runBench(char* sourcePath, char* benchOutput, plarray_t* commandBuf){
+	struct stat fileStat;
+
+	if(stat(sourcePath, &fileStat) != 0){
+		printf("%s: No such file or directory\n", sourcePath);
+		return 1;
 	}
 
-	if(!parseOnly){
-		if(!snippet)
-			plFPuts("enable\nconfig t\n", generatedConfig);
-
-		for(int i = 0; i < tables->size; i++){
-			((plfile_t**)generatedSnippets.array)[i] = ciscoParseTable(tableArr[i], gc);
-			if(generatedSnippets.size + 1 >= 2){
-				void* tempPtr = plGCRealloc(gc, generatedSnippets.array, (generatedSnippets.size + 2) * sizeof(plfile_t*));
-				if(!tempPtr){
-					printf("generateConfig: Internal pl32lib error\n");
-					return CISCO_ERROR_PL32LIB_GC;
-				}
+	plgc_t* benchGC = plGCInit(fileStat.st_size * 64 + 64 * 1024 * 1024);
+	plfunctionptr_t* commands = commandBuf->array;
+	plarray_t* args;
+	size_t lineCount = 0;
+	size_t tokenCount = 0;
+	double start;
 
-				generatedSnippets.array = tempPtr;
-			}
-			generatedSnippets.size++;
-		}
+	model = ciscoCreateModel(benchGC);
 
-		for(int i = 0; i < interfaces->size; i++){
-			((plfile_t**)generatedSnippets.array)[tables->size + i] = ciscoParseInterface(interfaceArr[i], gc);
-			if(generatedSnippets.size + 1 >= 2){
-				void* tempPtr = plGCRealloc(gc, generatedSnippets.array, generatedSnippets.size + 2);
-				if(!tempPtr){
-					printf("generateConfig: Internal pl32lib error\n");
-					return CISCO_ERROR_PL32LIB_GC;
-				}
+	// The source is tokenized in place, so tokenizing on its own and parsing
+	// are timed over two separate mappings of the same file
+	start = getTime();
+	ciscosource_t* source = ciscoOpenSource(sourcePath, benchGC);
+	double readTime = getTime() - start;
+
+	if(!source){
+		printf("%s: Unable to open file\n", sourcePath);
+		return 1;
+	}
 
-				generatedSnippets.array = tempPtr;
+	size_t inputSize = ciscoSourceGetSize(source);
+
+	start = getTime();
+	while((args = ciscoSourceNextLine(source)) != NULL)
+		tokenCount += args->size;
+	double tokenizeTime = getTime() - start;
+	lineCount = ciscoSourceGetLine(source);
+	ciscoCloseSource(source);
+
+	source = ciscoOpenSource(sourcePath, benchGC);
+	if(!source){
+		printf("%s: Unable to open file\n", sourcePath);
+		return 1;
+	}
+
+	start = getTime();
+	while((args = ciscoSourceNextLine(source)) != NULL){
+		if(args->size == 0)
+			continue;
+
+		char* name = ((char**)args->array)[0];
+		for(size_t j = 0; j < commandBuf->size; j++){
+			if(strcmp(commands[j].name, name) == 0){
+				commands[j].function(args, benchGC);
+				break;
 			}
-			generatedSnippets.size++;
 		}
-	}else{
-		return 0;
 	}
+	double parseTime = getTime() - start - tokenizeTime;
+	ciscoCloseSource(source);
+
+	plarray_t* tables = ciscoModelGetTables(model);
+	plarray_t* interfaces = ciscoModelGetInterfaces(model);
+	ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_BUFFER, benchGC);
+	size_t allocCount = ciscoGetAllocCount();
 
-	for(int i = 0; i < generatedSnippets.size; i++){
-		plFCat(generatedConfig, ((plfile_t**)generatedSnippets.array)[i], SEEK_END, SEEK_SET, true);
+	start = getTime();
+	for(size_t i = 0; i < tables->size; i++)
+		ciscoRenderTable(((ciscotable_t**)tables->array)[i], sink);
+	double tableTime = getTime() - start;
+	size_t tableSize = ciscoSinkTell(sink);
+
+	start = getTime();
+	for(size_t i = 0; i < interfaces->size; i++)
+		ciscoRenderInterface(((ciscoint_t**)interfaces->array)[i], sink);
+	ciscoRenderProfilePorts(model, sink);
+	double interfaceTime = getTime() - start;
+	allocCount = ciscoGetAllocCount() - allocCount;
+
+	size_t outputSize = 0;
+	char* output = ciscoSinkGetBuffer(sink, &outputSize);
+	int fd = open(benchOutput, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if(fd < 0){
+		printf("%s: Unable to open file\n", benchOutput);
+		return 1;
 	}
 
-	plGCFree(gc, generatedSnippets.array);
+	start = getTime();
+	ciscosink_t* fileSink = ciscoCreateSink(CISCO_SINK_FD, benchGC, fd);
+	ciscoSinkWrite(fileSink, output, outputSize);
+	ciscoDestroySink(fileSink);
+	close(fd);
+	double writeTime = getTime() - start;
 
-	if(outputPath)
-		plFPToFile(outputPath, generatedConfig);
+	printf("Source: %s (%zu lines, %zu tokens, %zu bytes)\n", sourcePath, lineCount, tokenCount, inputSize);
+	printf("Model: %zu tables, %zu standalone interfaces\n", tables->size, interfaces->size);
+	printf("Output: %zu bytes, %zu heap allocations while rendering\n\n", outputSize, allocCount);
+	printf("%-18s %12s %14s %10s\n", "phase", "time (ms)", "lines/s", "MB/s");
+	printBenchPhase("read", readTime, lineCount, inputSize);
+	printBenchPhase("tokenize", tokenizeTime, lineCount, inputSize);
+	printBenchPhase("configCmdParser", parseTime, lineCount, inputSize);
+	printBenchPhase("render tables", tableTime, lineCount, tableSize);
+	printBenchPhase("render interfaces", interfaceTime, lineCount, outputSize - tableSize);
+	printBenchPhase("write", writeTime, lineCount, outputSize);
+	printBenchPhase("total", readTime + tokenizeTime + parseTime + tableTime + interfaceTime + writeTime, lineCount, inputSize);
 
+	plGCStop(benchGC);
+	return 0;
 }
 
-int configCmdParser(plarray_t* args, plgc_t* gc){
-	char** argv = args->array;
-	char* junk;
-	if(strcmp(argv[0], "int") == 0 || strcmp(argv[0], "interface") == 0){
-		if(args->size < 2){
-			printf("%s: Not enough arguments\n", argv[0]);
-			return CISCO_ERROR_INVALID_ACTION;
+// Parses a source serially and then on 1 to maxThreads threads, printing the
+// parse time and speedup of every run and whether its model renders the same
+// as the serial one
+int runParseScaling(char* sourcePath, long maxThreads, plarray_t* commandBuf){
+	plgc_t* serialGC = NULL;
+	ciscoregion_t* serialRegion = NULL;
+	ciscoregion_t* previousRegion = ciscoGetRegion();
+	char* serialOutput = NULL;
+	size_t serialSize = 0;
+	double serialTime = 0;
+	plarray_t variableBuf;
+	variableBuf.array = NULL;
+	variableBuf.size = 0;
+
+	printf("\n%-18s %12s %10s %10s\n", "parse threads", "time (ms)", "speedup", "output");
+
+	for(long threads = 0; threads <= maxThreads; threads++){
+		plgc_t* runGC = plGCInit(64 * 1024 * 1024);
+		ciscoregion_t* runRegion = ciscoCreateRegion(0);
+		ciscovector_t chunkMemory;
+		char name[32];
+		double start;
+		long retVar;
+
+		// Every run starts from an empty region, so none of them reuses
+		// memory warmed up by another
+		ciscoUseRegion(runRegion);
+		ciscoVectorInit(&chunkMemory, sizeof(chunkmemory_t), threads + 1, runGC);
+		model = ciscoCreateModel(runGC);
+
+		// Thread count 0 is the serial parser everything is compared against
+		start = getTime();
+		if(threads){
+			retVar = parseSourceParallel(sourcePath, threads, &variableBuf, commandBuf, &chunkMemory, runGC);
+		}else{
+			retVar = parseSource(sourcePath, &variableBuf, commandBuf, runGC);
 		}
+		double elapsed = getTime() - start;
 
-		if(interfaces->size > 2){
-			void* tempPtr = plGCAlloc(gc, (interfaces->size + 1) * sizeof(ciscoint_t*));
-			if(!tempPtr){
-				printf("%s: Internal pl32lib error\n", argv[0]);
-				return CISCO_ERROR_PL32LIB_GC;
-			}
-			interfaces->array = tempPtr;
+		if(retVar < 0){
+			printf("%s: Unable to open file\n", sourcePath);
+			ciscoUseRegion(previousRegion);
+			return 1;
 		}
 
-		ciscoint_t** array = interfaces->array;
-		size_t index = interfaces->size;
-		ciscoconst_t type = ciscoStringToIntType(argv[1]);
-		char* intNums = strchr(argv[1], '/');
-		uint8_t nums[2];
+		size_t outputSize = 0;
+		ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_BUFFER, runGC);
+		ciscoRenderModel(model, sink);
+		char* output = ciscoSinkGetBuffer(sink, &outputSize);
 
-		if(!intNums){
-			printf("%s: Invalid interface\n", argv[0]);
-			return CISCO_ERROR_INVALID_VALUE;
-		}
+		if(threads){
+			bool same = outputSize == serialSize && memcmp(output, serialOutput, outputSize) == 0;
+
+			snprintf(name, sizeof(name), "%ld", threads);
+			printf("%-18s %12.3f %9.2fx %10s\n", name, elapsed * 1000, elapsed > 0 ? serialTime / elapsed : 0, same ? "identical" : "DIFFERS");
 
-		while(strchr(intNums, '/') != NULL)
-			intNums++;
+			for(size_t i = 0; i < chunkMemory.items.size; i++){
+				chunkmemory_t* memory = ciscoVectorAt(&chunkMemory, i);
 
-		nums[0] = strtol(intNums, &junk, 10);
+				plGCStop(memory->gc);
+				ciscoDestroyRegion(memory->region);
+			}
 
-		if(strchr(intNums, '-') != NULL){
-			char* tempChr = strchr(intNums, '-');
-			char* tempPtr = plGCCalloc(gc, (tempChr - intNums) + 1, sizeof(char));
-			memcpy(tempPtr, intNums, tempChr - intNums);
-			nums[1] = strtol(tempChr + 1, &junk, 10);
-			intNums = tempPtr;
+			ciscoDestroyRegion(runRegion);
+			plGCStop(runGC);
 		}else{
-			nums[1] = nums[0];
+			serialGC = runGC;
+			serialRegion = runRegion;
+			serialOutput = output;
+			serialSize = outputSize;
+			serialTime = elapsed;
+			printf("%-18s %12.3f %9.2fx %10s\n", "serial", elapsed * 1000, 1.0, "-");
 		}
+	}
 
-		plGCFree(gc, intNums);
+	model = NULL;
+	ciscoUseRegion(previousRegion);
+	ciscoDestroyRegion(serialRegion);
+	plGCStop(serialGC);
+	return 0;
+}
 
-		array[index] = ciscoCreateInterface(type, nums[0], nums[1], gc);
+// Appends a source to the batch source list. Directories are expanded to the
+// regular files they contain
+int addBatchSource(ciscovector_t* sources, char* path, plgc_t* gc){
+	struct stat fileStat;
 
-		if(args->size >= 3){
-			int retVar = ciscoModifyInterface(array[index], gc, CISCO_MODTYPE_MODE, ciscoStringToMode(argv[2]));
-			if(retVar == CISCO_ERROR_INVALID_VALUE){
-				printf("%s: Invalid value\n", argv[0]);
-				return retVar;
-			}
+	if(stat(path, &fileStat) != 0){
+		printf("%s: No such file or directory\n", path);
+		return 1;
+	}
+
+	if(S_ISDIR(fileStat.st_mode)){
+		struct dirent** entries;
+		int amount = scandir(path, &entries, NULL, alphasort);
+
+		if(amount < 0){
+			printf("%s: Unable to read directory\n", path);
+			return 1;
 		}
 
-		if(args->size >= 4){
-			int retVar = ciscoModifyInterface(array[index], gc, CISCO_MODTYPE_IP_ADDR, argv[3]);
-			if(retVar == CISCO_ERROR_MISMATCHED_IPVER){
-				printf("%s: Mismatched IP version\n", argv[0]);
-				return retVar;
+		for(int i = 0; i < amount; i++){
+			if(entries[i]->d_name[0] != '.'){
+				char* fullPath = plGCAlloc(gc, strlen(path) + strlen(entries[i]->d_name) + 2);
+				sprintf(fullPath, "%s/%s", path, entries[i]->d_name);
+
+				if(stat(fullPath, &fileStat) == 0 && S_ISREG(fileStat.st_mode)){
+					addBatchSource(sources, fullPath, gc);
+				}else{
+					plGCFree(gc, fullPath);
+				}
 			}
+
+			free(entries[i]);
 		}
 
-		if(args->size >= 5){
-			uint8_t subMask = strtol(argv[4], &junk, 10);
+		free(entries);
+		return 0;
+	}
 
-			int retVar = ciscoModifyInterface(array[index], gc, CISCO_MODTYPE_SUBMASK, subMask);
-			if(retVar == CISCO_ERROR_OUT_OF_RANGE){
-				printf("%s: Out of range\n", argv[0]);
-				return retVar;
-			}
+	return ciscoVectorPush(sources, &path);
+}
+
+// Appends every path listed in a list file (one per line) to the batch source list
+int addBatchList(ciscovector_t* sources, char* listPath, plgc_t* gc){
+	plfile_t* listFile = plFOpen(listPath, "r", gc);
+	char line[4096];
+
+	if(!listFile){
+		printf("%s: Unable to open list file\n", listPath);
+		return 1;
+	}
+
+	while(plFGets(line, 4096, listFile) != NULL){
+		line[strcspn(line, "\r\n")] = '\0';
+
+		if(line[0] == '\0' || line[0] == '#')
+			continue;
+
+		char* path = plGCAlloc(gc, strlen(line) + 1);
+		strcpy(path, line);
+		addBatchSource(sources, path, gc);
+	}
+
+	plFClose(listFile);
+	return 0;
+}
+
+// Sorts batch jobs by output path, keeping the order of their sources
+int compareBatchOutputs(const void* a, const void* b){
+	batchjob_t* jobA = *(batchjob_t**)a;
+	batchjob_t* jobB = *(batchjob_t**)b;
+	int retVar = strcmp(jobA->outputPath, jobB->outputPath);
+
+	if(retVar)
+		return retVar;
+
+	return jobA < jobB ? -1 : jobA > jobB;
+}
+
+// Renders every source into outputDir on jobCount threads and prints a summary
+int runBatch(plarray_t* sources, char* outputDir, long jobCount, plarray_t* commandBuf, plgc_t* gc){
+	char** sourceArr = sources->array;
+	batchqueue_t queue;
+	struct timespec start;
+	struct timespec end;
+	size_t failed = 0;
+
+	queue.jobs = plGCCalloc(gc, sources->size + 1, sizeof(batchjob_t));
+	queue.size = sources->size;
+	queue.next = 0;
+	queue.commandBuf = commandBuf;
+	queue.reservedBytes = 0;
+	queue.subnets = ciscoCreateSubnetCheck();
+	pthread_mutex_init(&queue.lock, NULL);
+
+	if(!queue.subnets){
+		printf("Internal error: Unable to create the subnet check\n");
+		return 1;
+	}
+
+	for(size_t i = 0; i < sources->size; i++){
+		char* baseName = strrchr(sourceArr[i], '/') ? strrchr(sourceArr[i], '/') + 1 : sourceArr[i];
+		size_t baseSize = strchr(baseName, '.') && strchr(baseName, '.') != baseName ? (size_t)(strrchr(baseName, '.') - baseName) : strlen(baseName);
+
+		queue.jobs[i].sourcePath = sourceArr[i];
+		queue.jobs[i].outputPath = plGCAlloc(gc, strlen(outputDir) + baseSize + 7);
+		sprintf(queue.jobs[i].outputPath, "%s/%.*s.conf", outputDir, (int)baseSize, baseName);
+	}
+
+	// Sources with the same base name (or listed twice) would write the same
+	// output file at once, so only the first of them is rendered
+	batchjob_t** sortedJobs = plGCCalloc(gc, sources->size + 1, sizeof(batchjob_t*));
+
+	for(size_t i = 0; i < sources->size; i++)
+		sortedJobs[i] = &queue.jobs[i];
+
+	qsort(sortedJobs, sources->size, sizeof(batchjob_t*), compareBatchOutputs);
+
+	batchjob_t* firstJob = sortedJobs[0];
+
+	for(size_t i = 1; i < sources->size; i++){
+		if(strcmp(sortedJobs[i]->outputPath, firstJob->outputPath) == 0){
+			sortedJobs[i]->sameOutput = firstJob->sourcePath;
+			sortedJobs[i]->status = CISCO_ERROR_INVALID_ACTION;
+		}else{
+			firstJob = sortedJobs[i];
 		}
+	}
 
-		if(args->size >= 6){
-			int retVar = ciscoModifyInterface(array[index], gc, CISCO_MODTYPE_DESC, argv[5]);
-			if(retVar == CISCO_ERROR_BUFFER_OVERFLOW){
-				printf("%s: Buffer overflow", argv[0]);
-				return retVar;
+	plGCFree(gc, sortedJobs);
+
+	if(jobCount < 1)
+		jobCount = 1;
+
+	if((size_t)jobCount > sources->size && sources->size > 0)
+		jobCount = sources->size;
+
+	pthread_t* threads = plGCAlloc(gc, jobCount * sizeof(pthread_t));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	long started = 0;
+
+	while(started < jobCount && pthread_create(&threads[started], NULL, batchWorker, &queue) == 0)
+		started++;
+
+	// Whatever the workers that did start leave over is rendered on this
+	// thread, which mustn't lose its own model or region to the worker
+	if(started < jobCount){
+		ciscomodel_t* callerModel = model;
+		ciscoregion_t* callerRegion = ciscoGetRegion();
+
+		batchWorker(&queue);
+		ciscoUseRegion(callerRegion);
+		model = callerModel;
+		jobCount = started + 1;
+	}
+
+	for(long i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	pthread_mutex_destroy(&queue.lock);
+
+	for(size_t i = 0; i < queue.size; i++){
+		batchjob_t* job = &queue.jobs[i];
+
+		if(job->status){
+			failed++;
+			if(job->sameOutput){
+				printf("FAIL %10.3f ms  %s (same output file as %s)\n", job->elapsed * 1000, job->sourcePath, job->sameOutput);
+			}else if(job->failedLine){
+				printf("FAIL %10.3f ms  %s (line %zu)\n", job->elapsed * 1000, job->sourcePath, job->failedLine);
+			}else{
+				printf("FAIL %10.3f ms  %s (I/O error)\n", job->elapsed * 1000, job->sourcePath);
 			}
+		}else{
+			printf("OK   %10.3f ms  %s -> %s (%zu bytes, %zu KiB peak)\n", job->elapsed * 1000, job->sourcePath, job->outputPath, job->outputSize, job->peakBytes / 1024);
 		}
+	}
 
-		interfaces->size++;
-	}else if(strcmp(argv[0], "vlan") == 0 || strcmp(argv[0], "ether") == 0){
-		if(args->size < 2){
-			printf("%s: Not enough args\n", argv[0]);
-			return CISCO_ERROR_INVALID_ACTION;
+	// Addresses are checked across every device of the batch at once
+	const ciscosubnetissue_t* issues;
+	size_t issueCount = ciscoSubnetCheckRun(queue.subnets, &issues);
+
+	if(issueCount)
+		printf("\n");
+
+	for(size_t i = 0; i < issueCount; i++)
+		printSubnetIssue("WARN ", &issues[i], sourceArr);
+
+	double totalTime = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("\n%zu files, %zu failed, %zu address warnings, %ld threads, %.3f s total, %zu KiB reserved by the largest worker\n", queue.size, failed, issueCount, jobCount, totalTime, queue.reservedBytes / 1024);
+
+	ciscoDestroySubnetCheck(queue.subnets);
+	plGCFree(gc, threads);
+	return failed ? 1 : 0;
+}
+
+// Generates the configuration of every "SOURCE DEVICE" line of a list file
+// and pushes all of them at once, each to its own device
+int runPushList(char* listPath, plarray_t* commandBuf, plgc_t* gc){
+	plfile_t* listFile = plFOpen(listPath, "r", gc);
+	plarray_t variableBuf;
+	ciscovector_t jobList;
+	size_t failed = 0;
+	char line[4096];
+
+	variableBuf.array = NULL;
+	variableBuf.size = 0;
+	ciscoVectorInit(&jobList, sizeof(pushjob_t), 8, gc);
+
+	if(!listFile){
+		printf("%s: Unable to open list file\n", listPath);
+		return 1;
+	}
+
+	while(plFGets(line, 4096, listFile) != NULL){
+		char sourcePath[4096];
+		char devicePath[4096];
+
+		if(line[0] == '#' || sscanf(line, "%4095s %4095s", sourcePath, devicePath) != 2)
+			continue;
+
+		pushjob_t job;
+		job.sourcePath = plGCAlloc(gc, strlen(sourcePath) + 1);
+		job.devicePath = plGCAlloc(gc, strlen(devicePath) + 1);
+		strcpy(job.sourcePath, sourcePath);
+		strcpy(job.devicePath, devicePath);
+		job.fd = -1;
+		job.push = NULL;
+		job.failedLine = 0;
+		job.status = 0;
+		ciscoVectorPush(&jobList, &job);
+	}
+
+	plFClose(listFile);
+
+	pushjob_t* jobs = jobList.items.array;
+	size_t jobCount = jobList.items.size;
+
+	ciscopush_t** pushes = plGCAlloc(gc, (jobCount + 1) * sizeof(ciscopush_t*));
+	ciscoconst_t* results = plGCAlloc(gc, (jobCount + 1) * sizeof(ciscoconst_t));
+	pushjob_t** running = plGCAlloc(gc, (jobCount + 1) * sizeof(pushjob_t*));
+	size_t runCount = 0;
+
+	// Every device gets its own model and output, all of them are kept until
+	// the pushes are done
+	for(size_t i = 0; i < jobCount; i++){
+		pushjob_t* job = &jobs[i];
+
+		model = ciscoCreateModel(gc);
+		job->failedLine = parseSource(job->sourcePath, &variableBuf, commandBuf, gc);
+
+		if(job->failedLine){
+			job->status = job->failedLine < 0 ? CISCO_ERROR_IO : CISCO_ERROR_INVALID_VALUE;
+			continue;
 		}
 
-		if(tables->size > 2){
-			void* tempPtr = plGCAlloc(gc, (tables->size + 1) * sizeof(ciscoint_t*));
-			if(!tempPtr){
-				printf("%s: Internal pl32lib error\n", argv[0]);
-				return CISCO_ERROR_PL32LIB_GC;
+		ciscosink_t* sink = ciscoCreateSink(CISCO_SINK_BUFFER, gc);
+		size_t size = 0;
+
+		ciscoSinkSetCompact(sink, compact);
+		if(!snippet)
+			ciscoSinkPuts(sink, compact ? "en\nconf t\n" : "enable\nconfig t\n");
+
+		job->status = coalesce ? ciscoRenderModelCoalesced(model, sink) : ciscoRenderModel(model, sink);
+		job->fd = job->status ? -1 : openDevice(job->devicePath);
+
+		if(job->fd < 0){
+			job->status = CISCO_ERROR_IO;
+			continue;
+		}
+
+		char* text = ciscoSinkGetBuffer(sink, &size);
+		job->push = ciscoCreatePush(job->fd, text, size, pushWindow, CISCO_PUSH_TIMEOUT, gc);
+		pushes[runCount] = job->push;
+		running[runCount] = job;
+		runCount++;
+	}
+
+	model = NULL;
+	ciscoPushRunAll(pushes, runCount, results);
+
+	for(size_t i = 0; i < runCount; i++)
+		running[i]->status = results[i];
+
+	for(size_t i = 0; i < jobCount; i++){
+		pushjob_t* job = &jobs[i];
+		ciscopushstats_t stats;
+
+		if(!job->push){
+			failed++;
+			if(job->failedLine > 0){
+				printf("FAIL %s -> %s (line %ld)\n", job->sourcePath, job->devicePath, job->failedLine);
+			}else{
+				printf("FAIL %s -> %s (unable to open)\n", job->sourcePath, job->devicePath);
 			}
-			tables->array = tempPtr;
+
+			continue;
 		}
 
-		uint16_t number = strtol(argv[1], &junk, 10);
-		ciscotable_t** array = tables->array;
-		size_t index = tables->size;
+		ciscoPushGetStats(job->push, &stats);
+		printf("%-4s %s -> %s: %zu/%zu lines in %.3f s (%.1f lines/s)", job->status ? "FAIL" : "OK", job->sourcePath, job->devicePath, stats.linesAcked, stats.totalLines, stats.elapsed, stats.linesPerSecond);
 
-		if(strcmp(argv[0], "vlan")){
-			array[index] = ciscoCreateTable(CISCO_INT_VLAN, CISCO_MODE_AUTO, number, gc);
-		}else{
-			array[index] = ciscoCreateTable(CISCO_INT_PORTCH, CISCO_MODE_AUTO, number, gc);
+		if(job->status == CISCO_ERROR_TIMEOUT){
+			printf(", device stopped responding");
+		}else if(job->status){
+			printf(", connection lost");
 		}
 
-		tables->size++;
+		if(stats.errors)
+			printf(", %zu device errors (first on line %zu)", stats.errors, stats.firstErrorLine);
+
+		printf("\n");
+
+		if(job->status)
+			failed++;
+
+		ciscoDestroyPush(job->push);
+		close(job->fd);
 	}
+
+	printf("\n%zu devices, %zu failed\n", jobCount, failed);
+	return failed ? 1 : 0;
 }
 
 int main(int argc, char* argv[]){
+	// ciscolib objects live in a region that grows as needed, the memory
+	// tracker only holds the frontend's own allocations
 	plgc_t* mainGC = plGCInit(8 * 1024 * 1024);
-	interfaces = plGCAlloc(mainGC, sizeof(plarray_t));
-	interfaces->array = plGCAlloc(mainGC, 2 * sizeof(ciscoint_t*));
-	tables = plGCAlloc(mainGC, sizeof(plarray_t));
-	tables->array = plGCAlloc(mainGC, 2 * sizeof(ciscoint_t*));
-	generatedConfig = plFOpen(NULL, "w+", mainGC);
+	ciscoUseRegion(ciscoCreateRegion(0));
+	model = ciscoCreateModel(mainGC);
+	generatedConfig = ciscoCreateSink(CISCO_SINK_BUFFER, mainGC);
 	char* sourcePath = NULL;
-	plfile_t* sourceFile = NULL;
+	char* batchDir = NULL;
+	char* deltaPath = NULL;
+	char* pushList = NULL;
+	char* loadPath = NULL;
+	char* savePath = NULL;
+	bool bench = false;
+	bool stats = false;
+	long jobCount = sysconf(_SC_NPROCESSORS_ONLN);
+	ciscovector_t batchSources;
+	ciscoVectorInit(&batchSources, sizeof(char*), 16, mainGC);
 
 	if(argc > 1){
 		for(int i = 1; i < argc; i++){
 			if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0){
 				printf("Cisco Configurator v0.56\n");
 				printf("(c)2022 pocketlinux32, Under GPLv3\n\n");
-				printf("Usage: %s { --help | --out OUTPUT | --parse | --verbose | --snippet | --terminal TERM_DEV } [ SOURCE ]\n", argv[0]);
+				printf("Usage: %s { --help | --out OUTPUT | --parse | --verbose | --snippet | --compact | --no-coalesce | --terminal TERM_DEV | --delta BASE_SOURCE | --parse-threads N } [ SOURCE ]\n", argv[0]);
+				printf("       %s --push-list LIST_FILE [ --baud RATE ] [ --flow FLOW ] [ --window N ]\n", argv[0]);
+				printf("       %s --batch OUTPUT_DIR [ --jobs N ] [ --list LIST_FILE ] [ SOURCE... ]\n", argv[0]);
 				printf("Generates a configuration script for a Cisco device. If no arguments given, it runs in interactive\n");
 				printf("mode and outputs generated configuration to stdout.\n\n");
 				printf("-h|--help		Shows this help.\n");
@@ -231,8 +1881,38 @@ int main(int argc, char* argv[]){
 				printf("-p|--parse		Only parses the configuration (verbosity must be enabled).\n");
 				printf("-s|--snippet		Generates the configuration without the header (\"enable\\nconfig t\\n\"). This option\n");
 				printf("			ignores any output files and only writes to either stdout or a terminal device.\n\n");
+				printf("-c|--compact		Generates the configuration with abbreviated keywords (\"sw mo acc\") and without the\n");
+				printf("			exit lines and VLAN 1 access lines IOS doesn't need. With --verbose, also prints how\n");
+				printf("			many bytes that saves.\n\n");
+				printf("-n|--no-coalesce	Generates one block per interface instead of merging interfaces with identical\n");
+				printf("			settings into \"int range\" commands. Either way, regenerating only re-renders\n");
+				printf("			what changed.\n\n");
 				printf("-t|--terminal		Writes generated configuration to a terminal device. This is intended for 'flashing' the configuration\n");
-				printf("			to a Cisco device connected over serial, but it can be done to any terminal device.\n\n");
+				printf("			to a Cisco device connected over serial, but it can be done to any terminal device.\n");
+				printf("			Every command waits for the device prompt, with up to --window commands in flight.\n");
+				printf("-P|--push-list		Generates the configuration of every \"SOURCE DEVICE\" line of a list file and pushes\n");
+				printf("			all of them at once, printing the progress and speed of each device.\n");
+				printf("--baud			Line speed of the terminal device, from 1200 to 230400 (default 9600).\n");
+				printf("--flow			Flow control of the terminal device: none, rtscts or xonxoff (default none).\n");
+				printf("--window		Commands sent ahead of the device prompt, from 1 to 65535 (default %d).\n\n", CISCO_PUSH_WINDOW);
+				printf("-d|--delta		Only generates the commands needed to turn a device configured from BASE_SOURCE into\n");
+				printf("			one configured from SOURCE, including the \"no\" forms of anything that was removed.\n\n");
+				printf("-b|--batch		Generates configurations for every SOURCE concurrently, writing each one to OUTPUT_DIR as\n");
+				printf("			NAME.conf and printing a per-file summary. Directories given as SOURCE are expanded.\n");
+				printf("			A SOURCE whose NAME.conf another SOURCE already writes fails.\n");
+				printf("-j|--jobs		Number of worker threads used by --batch (defaults to the number of CPUs).\n");
+				printf("-l|--list		Reads additional batch sources from a file, one path per line.\n\n");
+				printf("--save-model		Saves the model built from SOURCE as a binary snapshot once SOURCE has been parsed.\n");
+				printf("--load-model		Starts from a snapshot saved with --save-model instead of an empty model. Without\n");
+				printf("			a SOURCE, the configuration is generated right away.\n\n");
+				printf("--parse-threads		Splits SOURCE into chunks that are parsed on N threads and merged in source order\n");
+				printf("			(default 1, which parses it on the main thread).\n\n");
+				printf("--bench			Times every stage of generating SOURCE separately and prints the throughput of\n");
+				printf("			each one. The output goes to OUTPUT if given, or /dev/null otherwise. Parsing is\n");
+				printf("			then timed on 1 to N threads, with N from --parse-threads or the number of CPUs.\n");
+				printf("--stats[=json]		Prints the wall and CPU time, allocations and bytes of every phase of the run\n");
+				printf("			(reading, tokenizing, parsing, rendering, splicing cached output and writing) along\n");
+				printf("			with the memory in use to stderr when it ends, as a table or as one JSON object.\n\n");
 				return 0;
 			}else if(strcmp(argv[i], "--verbose") == 0 || strcmp(argv[i], "-v") == 0){
 				verbose = true;
@@ -240,6 +1920,15 @@ int main(int argc, char* argv[]){
 				parseOnly = true;
 			}else if(strcmp(argv[i], "--snippet") == 0 || strcmp(argv[i], "-s") == 0){
 				snippet = true;
+			}else if(strcmp(argv[i], "--compact") == 0 || strcmp(argv[i], "-c") == 0){
+				compact = true;
+			}else if(strcmp(argv[i], "--no-coalesce") == 0 || strcmp(argv[i], "-n") == 0){
+				coalesce = false;
+			}else if(strcmp(argv[i], "--bench") == 0){
+				bench = true;
+			}else if(strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=json") == 0){
+				stats = true;
+				statsJson = strcmp(argv[i], "--stats=json") == 0;
 			}else if(strcmp(argv[i], "--out") == 0 || strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--terminal") == 0 || strcmp(argv[i], "-t") == 0){
 				if(i + 1 >= argc){
 					printf("%s requires an operand\n", argv[i]);
@@ -255,6 +1944,96 @@ int main(int argc, char* argv[]){
 					isTerminal = false;
 				}
 
+				i++;
+			}else if(strcmp(argv[i], "--baud") == 0 || strcmp(argv[i], "--flow") == 0 || strcmp(argv[i], "--window") == 0){
+				if(i + 1 >= argc){
+					printf("%s requires an operand\n", argv[i]);
+					printf("Try '%s --help' for more information\n", argv[0]);
+					return 1;
+				}
+
+				char* end;
+
+				if(strcmp(argv[i], "--baud") == 0){
+					unsigned long rate = strtoul(argv[i + 1], &end, 10);
+
+					if(end == argv[i + 1] || *end || rate > UINT32_MAX || !ciscoIsBaudRate(rate)){
+						printf("Invalid baud rate: %s\n", argv[i + 1]);
+						return 1;
+					}
+
+					baudRate = rate;
+				}else if(strcmp(argv[i], "--window") == 0){
+					pushWindow = strtol(argv[i + 1], &end, 10);
+
+					if(end == argv[i + 1] || *end || pushWindow < 1 || pushWindow > UINT16_MAX){
+						printf("Invalid window: %s\n", argv[i + 1]);
+						return 1;
+					}
+				}else if(strcmp(argv[i + 1], "rtscts") == 0){
+					flowControl = CISCO_FLOW_RTSCTS;
+				}else if(strcmp(argv[i + 1], "xonxoff") == 0){
+					flowControl = CISCO_FLOW_XONXOFF;
+				}else if(strcmp(argv[i + 1], "none") == 0){
+					flowControl = CISCO_FLOW_NONE;
+				}else{
+					printf("Invalid flow control: %s\n", argv[i + 1]);
+					return 1;
+				}
+
+				i++;
+			}else if(strcmp(argv[i], "--save-model") == 0 || strcmp(argv[i], "--load-model") == 0){
+				if(i + 1 >= argc){
+					printf("%s requires an operand\n", argv[i]);
+					printf("Try '%s --help' for more information\n", argv[0]);
+					return 1;
+				}
+
+				if(strcmp(argv[i], "--save-model") == 0){
+					savePath = argv[i + 1];
+				}else{
+					loadPath = argv[i + 1];
+				}
+
+				i++;
+			}else if(strcmp(argv[i], "--delta") == 0 || strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--push-list") == 0 || strcmp(argv[i], "-P") == 0){
+				if(i + 1 >= argc){
+					printf("%s requires an operand\n", argv[i]);
+					printf("Try '%s --help' for more information\n", argv[0]);
+					return 1;
+				}
+
+				if(strcmp(argv[i], "--delta") == 0 || strcmp(argv[i], "-d") == 0){
+					deltaPath = argv[i + 1];
+				}else{
+					pushList = argv[i + 1];
+				}
+
+				i++;
+			}else if(strcmp(argv[i], "--parse-threads") == 0){
+				if(i + 1 >= argc){
+					printf("%s requires an operand\n", argv[i]);
+					printf("Try '%s --help' for more information\n", argv[0]);
+					return 1;
+				}
+
+				parseThreads = strtol(argv[i + 1], NULL, 10);
+				i++;
+			}else if(strcmp(argv[i], "--batch") == 0 || strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--jobs") == 0 || strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--list") == 0 || strcmp(argv[i], "-l") == 0){
+				if(i + 1 >= argc){
+					printf("%s requires an operand\n", argv[i]);
+					printf("Try '%s --help' for more information\n", argv[0]);
+					return 1;
+				}
+
+				if(strcmp(argv[i], "--batch") == 0 || strcmp(argv[i], "-b") == 0){
+					batchDir = argv[i + 1];
+				}else if(strcmp(argv[i], "--jobs") == 0 || strcmp(argv[i], "-j") == 0){
+					jobCount = strtol(argv[i + 1], NULL, 10);
+				}else if(addBatchList(&batchSources, argv[i + 1], mainGC)){
+					return 1;
+				}
+
 				i++;
 			}else if(strchr(argv[i], '-') == argv[i]){
 				printf("Invalid option: %s\n", argv[i]);
@@ -262,13 +2041,14 @@ int main(int argc, char* argv[]){
 				return 1;
 			}else{
 				sourcePath = argv[i];
+				addBatchSource(&batchSources, argv[i], mainGC);
 			}
 		}
 	}
 
 	plarray_t commandBuf;
 	plarray_t variableBuf;
-	commandBuf.array = plGCAlloc(mainGC, 6 * sizeof(plfunctionptr_t));
+	commandBuf.array = plGCAlloc(mainGC, 12 * sizeof(plfunctionptr_t));
 	variableBuf.array = plGCAlloc(mainGC, 6 * sizeof(plvariable_t));
 
 	((plfunctionptr_t*)commandBuf.array)[0].function = configCmdParser;
@@ -279,11 +2059,23 @@ int main(int argc, char* argv[]){
 	((plfunctionptr_t*)commandBuf.array)[2].name = "ether";
 	((plfunctionptr_t*)commandBuf.array)[3].function = configCmdParser;
 	((plfunctionptr_t*)commandBuf.array)[3].name = "system";
-	((plfunctionptr_t*)commandBuf.array)[4].function = generateConfig;
-	((plfunctionptr_t*)commandBuf.array)[4].name = "generate";
-	((plfunctionptr_t*)commandBuf.array)[5].function = showConfig;
-	((plfunctionptr_t*)commandBuf.array)[5].name = "show";
-	commandBuf.size = 6;
+	((plfunctionptr_t*)commandBuf.array)[4].function = configCmdParser;
+	((plfunctionptr_t*)commandBuf.array)[4].name = "allow";
+	((plfunctionptr_t*)commandBuf.array)[5].function = generateConfig;
+	((plfunctionptr_t*)commandBuf.array)[5].name = "generate";
+	((plfunctionptr_t*)commandBuf.array)[6].function = showConfig;
+	((plfunctionptr_t*)commandBuf.array)[6].name = "show";
+	((plfunctionptr_t*)commandBuf.array)[7].function = poolCmdParser;
+	((plfunctionptr_t*)commandBuf.array)[7].name = "pool";
+	((plfunctionptr_t*)commandBuf.array)[8].function = poolCmdParser;
+	((plfunctionptr_t*)commandBuf.array)[8].name = "addr";
+	((plfunctionptr_t*)commandBuf.array)[9].function = profileCmdParser;
+	((plfunctionptr_t*)commandBuf.array)[9].name = "profile";
+	((plfunctionptr_t*)commandBuf.array)[10].function = profileCmdParser;
+	((plfunctionptr_t*)commandBuf.array)[10].name = "apply";
+	((plfunctionptr_t*)commandBuf.array)[11].function = profileCmdParser;
+	((plfunctionptr_t*)commandBuf.array)[11].name = "override";
+	commandBuf.size = 12;
 
 	((plvariable_t*)variableBuf.array)[0].varptr = &verbose;
 	((plvariable_t*)variableBuf.array)[0].type = PLSHVAR_BOOL;
@@ -311,18 +2103,104 @@ int main(int argc, char* argv[]){
 	((plvariable_t*)variableBuf.array)[5].isMemAlloc = false;
 	variableBuf.size = 6;
 
-	if(sourcePath)
-		sourceFile = plFOpen(sourcePath, "r", mainGC);
+	if(stats && (bench || batchDir || pushList)){
+		printf("--stats can't be combined with --bench, --batch or --push-list\n");
+		return 1;
+	}
 
-	if(!sourceFile){
-		plShellInteractive(NULL, true, &variableBuf, &commandBuf, mainGC);
-	}else{
-		printf("Source path has been specified. Using source file.\n");
-		char cmdline[4096];
-		while(plFGets(cmdline, 4096, sourceFile) != NULL){
-			plShell(cmdline, &variableBuf, &commandBuf, &mainGC);
+	// Stats are printed at exit, so runs that end in the interactive shell
+	// get them too
+	if(stats){
+		runStats = ciscoCreateStats();
+		ciscoUseStats(runStats);
+		atexit(printStats);
+	}
+
+	// Bench, push and batch runs render every source themselves once it's
+	// parsed, so they share the command table of a regular run with generate
+	// and show doing nothing, and fail a source on commands it doesn't know
+	nonInteractive = bench || pushList || batchDir;
+
+	if(bench){
+		if(!sourcePath){
+			printf("--bench requires a source file\n");
+			return 1;
+		}
+
+		int retVar = runBench(sourcePath, outputPath ? outputPath : "/dev/null", &commandBuf);
+		if(retVar)
+			return retVar;
+
+		return runParseScaling(sourcePath, parseThreads > 1 ? parseThreads : sysconf(_SC_NPROCESSORS_ONLN), &commandBuf);
+	}
+
+	if(pushList)
+		return runPushList(pushList, &commandBuf, mainGC);
+
+	if(batchDir)
+		return runBatch(&batchSources.items, batchDir, jobCount, &commandBuf, mainGC);
+
+	if(deltaPath){
+		// The base source only builds a model, it never generates anything
+		parsingBase = true;
+		long retVar = parseSource(deltaPath, &variableBuf, &commandBuf, mainGC);
+		parsingBase = false;
+
+		if(retVar < 0){
+			printf("%s: Unable to open file\n", deltaPath);
+			return 1;
+		}else if(retVar > 0){
+			printf("%s: Error on line %ld\n", deltaPath, retVar);
+			return 1;
+		}
+
+		baseModel = model;
+		model = ciscoCreateModel(mainGC);
+	}
+
+	if(loadPath){
+		model = ciscoLoadModel(loadPath, mainGC);
+
+		if(!model){
+			printf("%s: Not a valid model snapshot\n", loadPath);
+			return 1;
+		}
+
+		if(!sourcePath){
+			int retVar = generateConfig(NULL, mainGC);
+
+			if(!retVar && !outputPath){
+				size_t size = 0;
+				char* text = ciscoSinkGetBuffer(generatedConfig, &size);
+
+				ciscoStatsBegin(CISCO_PHASE_WRITE);
+				fwrite(text, sizeof(char), size, stdout);
+				fflush(stdout);
+				ciscoStatsEnd(CISCO_PHASE_WRITE, 1, size);
+			}
+
+			if(!retVar && savePath)
+				retVar = saveModel(savePath, mainGC);
+
+			return retVar ? 1 : 0;
 		}
 	}
 
+	if(sourcePath)
+		printf("Source path has been specified. Using source file.\n");
+
+	long retVar = -1;
+	if(sourcePath && parseThreads > 1){
+		retVar = parseSourceParallel(sourcePath, parseThreads, &variableBuf, &commandBuf, NULL, mainGC);
+	}else if(sourcePath){
+		retVar = parseSource(sourcePath, &variableBuf, &commandBuf, mainGC);
+	}
+
+	if(retVar < 0)
+		plShellInteractive(NULL, true, &variableBuf, &commandBuf, mainGC);
+
+	if(savePath)
+		return saveModel(savePath, mainGC);
+
 	return 0;
 }
@@ -0,0 +1,196 @@
+/************************************\
+* gen-ciscosrc, v0.56                *
+* (c)2022 pocketlinux32, Under GPLv3 *
+* Source file                        *
+\************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+// Generator settings
+typedef struct srcsettings {
+	long interfaces;
+	long vlans;
+	long portsPerVlan;
+	long etherchannels;
+	long trunks;
+	long svis;
+	long descPercent;
+	unsigned long seed;
+} srcsettings_t;
+
+const char* descriptions[] = { "Clients", "Printers", "Access_Points", "Cameras", "Phones", "Servers", "Management" };
+unsigned long randState = 1;
+long nextPort = 0;
+
+// Small LCG so output is reproducible for a given seed on every platform
+unsigned long nextRandom(){
+	randState = randState * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (randState >> 33) & 0x7fffffff;
+}
+
+// Writes the name of the nth physical port. Ports are laid out like a chassis
+// with 48 ports per module, so every port in a file is unique
+void writePort(FILE* output, long port){
+	fprintf(output, "g%ld/%ld/%ld", 1 + port / (48 * 256), (port / 48) % 256, port % 48 + 1);
+}
+
+// Writes a range of count ports starting at the next free port. Ranges never
+// cross a module boundary, so they may be split into a comma-separated list
+void writePortRange(FILE* output, long count){
+	bool first = true;
+
+	while(count > 0){
+		long inModule = 48 - nextPort % 48;
+		long size = count < inModule ? count : inModule;
+
+		if(!first)
+			fputc(',', output);
+
+		writePort(output, nextPort);
+		if(size > 1)
+			fprintf(output, "-%ld", nextPort % 48 + size);
+
+		nextPort += size;
+		count -= size;
+		first = false;
+	}
+}
+
+void writeDescription(FILE* output){
+	// Mostly shared descriptions, with the occasional unique one
+	if(nextRandom() % 8 == 0){
+		fprintf(output, " Desk_%ld", nextPort);
+	}else{
+		fprintf(output, " %s", descriptions[nextRandom() % (sizeof(descriptions) / sizeof(descriptions[0]))]);
+	}
+}
+
+void generateSource(FILE* output, srcsettings_t* settings){
+	long vlanCount = settings->vlans > 4093 ? 4093 : settings->vlans;
+
+	fprintf(output, "#!/usr/bin/gen-ciscoconf\n\n");
+
+	for(long i = 0; i < vlanCount; i++){
+		fprintf(output, "vlan %ld VLAN_%ld ", i + 2, i + 2);
+		if(settings->portsPerVlan > 0){
+			writePortRange(output, settings->portsPerVlan);
+			fprintf(output, " access\n");
+		}else{
+			fprintf(output, "noport nomode\n");
+		}
+	}
+
+	for(long i = 0; i < settings->etherchannels; i++){
+		fprintf(output, "ether %ld ", i + 1);
+		writePortRange(output, 2 + nextRandom() % 3);
+		fprintf(output, " active\n");
+	}
+
+	for(long i = 0; i < settings->trunks; i++){
+		long first = 2 + nextRandom() % (vlanCount > 0 ? vlanCount : 1);
+		long last = first + nextRandom() % 64;
+
+		fprintf(output, "int ");
+		writePort(output, nextPort);
+		nextPort++;
+		fprintf(output, " trunk\nallow %ld-%ld,%ld\n", first, last > 3999 ? 3999 : last, 4000 + nextRandom() % 94);
+	}
+
+	for(long i = 0; i < settings->svis; i++)
+		fprintf(output, "int vlan%ld access 10.%ld.%ld.1 24\n", 2 + i % 4093, (i / 256) % 256, i % 256);
+
+	for(long i = 0; i < settings->interfaces; i++){
+		fprintf(output, "int ");
+		writePort(output, nextPort);
+		nextPort++;
+		fprintf(output, " access");
+
+		// The description is the last positional argument of int, so ports
+		// with a description get an address as well, each in its own /30
+		if((long)(nextRandom() % 100) < settings->descPercent){
+			fprintf(output, " 172.%ld.%ld.%ld 30", 16 + (i >> 14) % 16, (i >> 6) & 0xff, (i & 63) * 4 + 1);
+			writeDescription(output);
+		}
+
+		fputc('\n', output);
+	}
+}
+
+int main(int argc, char* argv[]){
+	srcsettings_t settings = { 1000, 100, 8, 16, 8, 16, 30, 1 };
+	char* outputPath = NULL;
+	FILE* output = stdout;
+
+	for(int i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0){
+			printf("Synthetic source generator for gen-ciscoconf v0.56\n");
+			printf("(c)2022 pocketlinux32, Under GPLv3\n\n");
+			printf("Usage: %s [ OPTION VALUE ]...\n", argv[0]);
+			printf("Generates a gen-ciscoconf source file for benchmarking and writes it to stdout.\n\n");
+			printf("-h|--help		Shows this help.\n");
+			printf("-o|--out		Writes the source to a file instead of stdout.\n");
+			printf("-i|--interfaces		Standalone access interfaces (default 1000).\n");
+			printf("-v|--vlans		VLANs, at most 4093 (default 100).\n");
+			printf("-p|--ports-per-vlan	Access ports assigned to each VLAN (default 8).\n");
+			printf("-e|--etherchannels	EtherChannels of 2-4 ports (default 16).\n");
+			printf("-t|--trunks		Trunk interfaces with an allowed VLAN list (default 8).\n");
+			printf("-s|--svis		VLAN interfaces with an IPv4 address (default 16).\n");
+			printf("-d|--descriptions	Percentage of standalone interfaces with a description (default 30).\n");
+			printf("-r|--seed		Random seed (default 1).\n");
+			return 0;
+		}
+
+		if(i + 1 >= argc){
+			printf("%s requires an operand\n", argv[i]);
+			printf("Try '%s --help' for more information\n", argv[0]);
+			return 1;
+		}
+
+		if(strcmp(argv[i], "--out") == 0 || strcmp(argv[i], "-o") == 0){
+			outputPath = argv[i + 1];
+		}else if(strcmp(argv[i], "--interfaces") == 0 || strcmp(argv[i], "-i") == 0){
+			settings.interfaces = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--vlans") == 0 || strcmp(argv[i], "-v") == 0){
+			settings.vlans = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--ports-per-vlan") == 0 || strcmp(argv[i], "-p") == 0){
+			settings.portsPerVlan = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--etherchannels") == 0 || strcmp(argv[i], "-e") == 0){
+			settings.etherchannels = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--trunks") == 0 || strcmp(argv[i], "-t") == 0){
+			settings.trunks = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--svis") == 0 || strcmp(argv[i], "-s") == 0){
+			settings.svis = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--descriptions") == 0 || strcmp(argv[i], "-d") == 0){
+			settings.descPercent = strtol(argv[i + 1], NULL, 10);
+		}else if(strcmp(argv[i], "--seed") == 0 || strcmp(argv[i], "-r") == 0){
+			settings.seed = strtoul(argv[i + 1], NULL, 10);
+		}else{
+			printf("Invalid option: %s\n", argv[i]);
+			printf("Try '%s --help' for more information\n", argv[0]);
+			return 1;
+		}
+
+		i++;
+	}
+
+	randState = settings.seed;
+
+	if(outputPath){
+		output = fopen(outputPath, "w");
+
+		if(!output){
+			printf("%s: Unable to open file\n", outputPath);
+			return 1;
+		}
+	}
+
+	generateSource(output, &settings);
+
+	if(outputPath)
+		fclose(output);
+
+	return 0;
+}